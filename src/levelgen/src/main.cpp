@@ -1,11 +1,13 @@
 #include "phase1/Graph.hpp"
 #include "phase1/GraphLoader.hpp"
+#include "phase1/GraphPack.hpp"
+#include "phase1/LevelParser.hpp"
 
 #include <string>
 #include <vector>
-#include <cstdint>
 #include <iostream>
 #include <stdexcept>
+#include <utility>
 
 int
 main(int argc, char * argv[]) {
@@ -18,7 +20,24 @@ main(int argc, char * argv[]) {
       std::cout << "Caught exception: " << e.what() << std::endl;
     }
   }
+  else if (argc == 4 && std::string(argv[1]) == "compile") {
+    // levelgen compile levels.json levels.lgp
+    // Graphs are built straight from the parser's events, with no DOM.
+    try {
+      std::vector<Graph> graphs;
+      p1::parse_graphs_in_file(argv[2], [&](Graph && graph) {
+        graphs.push_back(std::move(graph));
+      });
+      p1::write_graph_pack(argv[3], graphs);
+      std::cout << "wrote " << graphs.size() << " graphs to " << argv[3]
+                << std::endl;
+    }
+    catch (std::runtime_error const & e) {
+      std::cout << "Caught exception: " << e.what() << std::endl;
+    }
+  }
   else {
-    std::cout << "needs 1 parameter - filename" << std::endl;
+    std::cout << "needs 1 parameter - filename\n"
+              << "   or: compile <levels.json> <graphs.lgp>" << std::endl;
   }
 }
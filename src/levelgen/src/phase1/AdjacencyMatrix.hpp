@@ -2,15 +2,21 @@
 
 #include <numeric>
 #include <cassert>
+#include <memory_resource>
 #include <vector>
 
 namespace matrix {
 
 class AdjacencyMatrix {
 public:
-  AdjacencyMatrix(int num_vertices)
+  using BitVec = std::pmr::vector<bool>;
+
+  // As with Vertices, moves keep the resource and copies use the default one.
+  AdjacencyMatrix(int                         num_vertices,
+                  std::pmr::memory_resource * resource =
+                      std::pmr::get_default_resource())
       : num_vertices_(num_vertices),
-        adjacency_matrix_(num_vertices * num_vertices) {
+        adjacency_matrix_(num_vertices * num_vertices, false, resource) {
   }
 
   void
@@ -137,7 +143,7 @@ public:
     num_vertices_ = num_vertices;
   }
 
-  std::vector<bool> const &
+  BitVec const &
   adjacency_matrix() const {
     return adjacency_matrix_;
   }
@@ -155,7 +161,7 @@ private:
 
   // Minimizing allocations is desirable.  This gives 64 edges in 8 bytes.
   // TODO: make a small SBO version that doesn't usually allocate anything?
-  std::vector<bool> adjacency_matrix_;
+  BitVec adjacency_matrix_;
 };
 
 } // namespace matrix
@@ -0,0 +1,60 @@
+#pragma once
+
+#include "Block.hpp"
+#include "RuleSide.hpp"
+#include "Vertex.hpp"
+
+#include <string_view>
+
+// How one chain of a rule becomes vertices and edges, for GraphCreator at run
+// time and StaticGraph at compile time alike. Each suffix of the chain is one
+// vertex, which the builder looks up or makes:
+//
+//   int  find_vertex(int i)                           chain.substr(i), or -1
+//   int  add_vertex(int i, vertex::VertexRole role)   its new index
+//   void mark_start(int idx)
+//   void add_edge(int from_idx, int to_idx)
+//
+// Only the builders differ in how vertices are stored and named.
+
+namespace chain_walk {
+
+// an empty "to" chain stands for a vertex of nothing
+constexpr std::string_view
+nonempty(std::string_view chain) {
+  return chain.empty() ? std::string_view(block::NOTHING_BLOCK_CSTR) : chain;
+}
+
+// the first vertex of a "from" chain is where matching starts
+constexpr vertex::VertexRole
+role_of(RuleSide side, int i) {
+  return side == RuleSide::FROM && i == 0 ? vertex::VertexRole::START
+                                          : vertex::VertexRole::INTERNAL;
+}
+
+// Returns the chain's last vertex; prev_idx, if not -1, gets an edge to its
+// first one.
+template <typename BuilderT>
+constexpr int
+walk(BuilderT & builder, std::string_view chain, RuleSide side,
+     int prev_idx) {
+  int idx = -1;
+  for (int i = 0, len = chain.size(); i < len; ++i) {
+    auto role = role_of(side, i);
+    idx       = builder.find_vertex(i);
+    if (idx == -1) {
+      idx = builder.add_vertex(i, role);
+    }
+    else if (role == vertex::VertexRole::START) {
+      builder.mark_start(idx);
+    }
+
+    if (prev_idx != -1) {
+      builder.add_edge(prev_idx, idx);
+    }
+    prev_idx = idx;
+  }
+  return idx;
+}
+
+} // namespace chain_walk
@@ -0,0 +1,110 @@
+#pragma once
+
+#include "Color.hpp"
+#include "Vertex.hpp"
+#include "hash_utils.hpp"
+
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
+// A graph fingerprint is a hash that isomorphic graphs always share, and that
+// other graphs almost never do. Everything here is constexpr, so a graph built
+// at compile time (see StaticGraph.hpp) can have its fingerprint checked with
+// static_assert, and compared with the same graph built at run time.
+
+namespace fingerprint {
+
+using Hash = std::uint64_t;
+
+constexpr int DefaultIterations = 3;
+
+// A hash of everything about a single vertex that survives the relabeling
+// check_isomorphism allows: color, start bit, size, and (for colors with
+// dynamic blocks) only the pattern of repeated blocks rather than values.
+// Dynamic block colors may be consistently relabeled across the whole graph,
+// so their actual values are not comparable between graphs. Only the pattern
+// of repeats within the vertex is: "aab" and "ccd" both become 1,1,2.
+constexpr Hash
+vertex_label(vertex::Vertex vertex) {
+  auto const color = get_final_color(vertex);
+  auto const sz    = size(vertex);
+
+  Hash label = hashing::combine(+color, get_start_bit(vertex));
+  label      = hashing::combine(label, sz);
+
+  bool const dynamic = has_dynamic_block_colors(color);
+  auto const blocks  = get_blocks(vertex);
+  for (int i = 0; i < sz; ++i) {
+    int value = +blocks[i];
+    if (dynamic) {
+      value = std::find(begin(blocks), begin(blocks) + i, blocks[i]) -
+              begin(blocks) + 1;
+    }
+    label = hashing::combine(label, value);
+  }
+  return label;
+}
+
+// vertex_label of a vertex, folded together with those of its continuation
+// records (see Vertices::continuation_of)
+template <typename RecordsT>
+constexpr Hash
+run_label(vertex::Vertex vertex, RecordsT const & records) {
+  Hash label = vertex_label(vertex);
+  for (vertex::Vertex record : records) {
+    label = hashing::combine(label, vertex_label(record));
+  }
+  return label;
+}
+
+// Weisfeiler-Lehman relabeling, as in Graph::wl_features, folded down to one
+// hash: each round relabels every vertex with its own label plus the sorted
+// labels of its children and of its parents, and the sorted labels of every
+// round go into the result. label_of(i) gives vertex i's starting label and
+// has_edge(i, j) the edges, so any graph representation can be used.
+template <typename LabelFn, typename EdgeFn>
+constexpr Hash
+compute(int size, LabelFn label_of, EdgeFn has_edge,
+        int iterations = DefaultIterations) {
+  std::vector<Hash> labels(size), next_labels(size), neighbors, sorted;
+
+  Hash result      = hashing::combine(0, size);
+  auto fold_sorted = [&](Hash seed, std::vector<Hash> & values) {
+    std::sort(values.begin(), values.end());
+    for (Hash value : values) {
+      seed = hashing::combine(seed, value);
+    }
+    values.clear();
+    return seed;
+  };
+
+  for (int i = 0; i < size; ++i) {
+    labels[i] = label_of(i);
+  }
+  sorted = labels;
+  result = fold_sorted(result, sorted);
+
+  for (int iteration = 1; iteration <= iterations; ++iteration) {
+    for (int i = 0; i < size; ++i) {
+      for (int j = 0; j < size; ++j) {
+        if (has_edge(i, j)) {
+          neighbors.push_back(labels[j]);
+        }
+      }
+      Hash label = fold_sorted(hashing::combine(labels[i], 'C'), neighbors);
+      for (int j = 0; j < size; ++j) {
+        if (has_edge(j, i)) {
+          neighbors.push_back(labels[j]);
+        }
+      }
+      next_labels[i] = fold_sorted(hashing::combine(label, 'P'), neighbors);
+    }
+    labels.swap(next_labels);
+    sorted = labels;
+    result = fold_sorted(hashing::combine(result, iteration), sorted);
+  }
+  return result;
+}
+
+} // namespace fingerprint
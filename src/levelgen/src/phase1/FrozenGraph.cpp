@@ -0,0 +1,236 @@
+#include "FrozenGraph.hpp"
+#include "Isomorphism.hpp"
+#include "hash_utils.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <limits>
+#include <stdexcept>
+
+namespace {
+
+constexpr std::uint64_t
+words_for(std::uint64_t bytes) {
+  using Word = FrozenGraphView::Word;
+  return (bytes + sizeof(Word) - 1) / sizeof(Word);
+}
+
+constexpr std::uint64_t HeaderWords =
+    words_for(sizeof(FrozenGraphView::Header));
+
+} // namespace
+
+FrozenGraphView::Layout
+FrozenGraphView::layout_of(Header const & header) {
+  // in 64 bits, so a header with huge counts can't wrap around to a layout
+  // that fits
+  std::uint64_t const n = header.num_vertices;
+
+  Layout layout;
+  layout.ranges     = HeaderWords;
+  layout.shape_keys =
+      layout.ranges +
+      words_for(std::uint64_t(header.num_ranges) * sizeof(IndexRange));
+  layout.vertices   = layout.shape_keys + words_for(n * sizeof(ShapeKey));
+  layout.run_starts = layout.vertices + words_for(n * sizeof(vertex::Vertex));
+  layout.records =
+      layout.run_starts + words_for((n + 1) * sizeof(std::uint32_t));
+  layout.rows =
+      layout.records +
+      words_for(std::uint64_t(header.num_records) * sizeof(vertex::Vertex));
+  layout.name      = layout.rows + n * header.row_words;
+  layout.num_words = layout.name + words_for(header.name_length);
+  return layout;
+}
+
+FrozenGraphView::FrozenGraphView(WordSpan words) : words_(words) {
+  if (words.size() < HeaderWords) {
+    throw std::runtime_error("Frozen graph too short for its header");
+  }
+  auto const & hdr = header();
+  if (hdr.magic != Magic || hdr.version != Version) {
+    throw std::runtime_error("Not a frozen graph, or another version");
+  }
+  if (hdr.vertex_bytes != sizeof(vertex::Vertex)) {
+    throw std::runtime_error("Frozen graph uses another vertex layout");
+  }
+  // has_edge trusts each row to hold a bit for every vertex
+  if (hdr.row_words != (std::uint64_t(hdr.num_vertices) + WordBits - 1) /
+                           WordBits) {
+    throw std::runtime_error("Frozen graph rows are the wrong length");
+  }
+  layout_ = layout_of(hdr);
+  if (layout_.num_words != hdr.num_words || hdr.num_words > words.size()) {
+    throw std::runtime_error("Frozen graph is truncated");
+  }
+  words_ = words.first(hdr.num_words);
+
+  // continuation_of trusts these to stay inside the records
+  auto const *  run_starts = section<std::uint32_t>(layout_.run_starts);
+  std::uint32_t prev       = 0;
+  for (std::uint32_t i = 0; i <= hdr.num_vertices; ++i) {
+    if (run_starts[i] < prev) {
+      throw std::runtime_error("Frozen graph run starts are out of order");
+    }
+    prev = run_starts[i];
+  }
+  if (prev != hdr.num_records) {
+    throw std::runtime_error("Frozen graph run starts don't cover its records");
+  }
+
+  // isomorphism::check permutes vertices within these, trusting them to be
+  // in order and inside the graph
+  Index range_end = 0;
+  for (auto [from, to] : permutable_block_ranges()) {
+    if (from < range_end || to <= from || to > size()) {
+      throw std::runtime_error("Frozen graph permutable ranges are invalid");
+    }
+    range_end = to;
+  }
+}
+
+FrozenGraphView::VertexSpan
+FrozenGraphView::continuation_of(Index idx) const {
+  auto const * run_starts = section<std::uint32_t>(layout_.run_starts);
+  auto const * records    = section<vertex::Vertex>(layout_.records);
+  return {records + run_starts[idx], records + run_starts[idx + 1]};
+}
+
+bool
+FrozenGraphView::check_isomorphism(FrozenGraphView const & other) const {
+  std::vector<Index> indices(size());
+  return isomorphism::check(*this, other, indices);
+}
+
+bool
+FrozenGraphView::check_isomorphism(Graph const & other) const {
+  std::vector<Index> indices(size());
+  return isomorphism::check(*this, other, indices);
+}
+
+fingerprint::Hash
+FrozenGraphView::fingerprint() const {
+  return fingerprint::compute(
+      size(),
+      [this](Index i) {
+        return fingerprint::run_label(vertex_at(i), continuation_of(i));
+      },
+      [this](Index i, Index j) { return has_edge(i, j); });
+}
+
+std::uint64_t
+FrozenGraphView::hash() const {
+  std::uint64_t result = hashing::combine(0, words_.size());
+  for (Word word : words_) {
+    result = hashing::combine(result, word);
+  }
+  return result;
+}
+
+bool
+FrozenGraphView::operator==(FrozenGraphView const & other) const {
+  return std::ranges::equal(words_, other.words_);
+}
+
+// copies count Ts into the section at offset, starting from its at'th T
+template <typename T>
+static void
+write_section(std::vector<FrozenGraphView::Word> & buffer,
+              std::uint64_t offset, T const * data, std::size_t count,
+              std::size_t at = 0) {
+  if (count != 0) {
+    auto * section = reinterpret_cast<std::byte *>(buffer.data() + offset);
+    std::memcpy(section + at * sizeof(T), data, count * sizeof(T));
+  }
+}
+
+std::vector<FrozenGraph::Word>
+FrozenGraph::pack(Graph const & graph, bool with_name) {
+  auto const & vertices = graph.vertices();
+  auto const   n        = graph.size();
+  auto const & ranges   = graph.permutable_block_ranges();
+
+  std::uint32_t num_records = 0;
+  for (Index i = 0; i < n; ++i) {
+    num_records += vertices.continuation_of(i).size();
+  }
+
+  Header hdr{};
+  hdr.magic        = Magic;
+  hdr.version      = Version;
+  hdr.vertex_bytes = sizeof(vertex::Vertex);
+  hdr.num_vertices = n;
+  hdr.num_ranges   = ranges.size();
+  hdr.num_records  = num_records;
+  hdr.row_words    = (n + WordBits - 1) / WordBits;
+  hdr.name_length  = with_name ? graph.level_name().size() : 0;
+
+  auto const layout = layout_of(hdr);
+  if (layout.num_words > std::numeric_limits<std::uint32_t>::max()) {
+    throw std::runtime_error("Graph too large to freeze");
+  }
+  hdr.num_words = layout.num_words;
+
+  // the one allocation; everything below fills it in place
+  std::vector<Word> buffer(layout.num_words);
+  write_section(buffer, 0, &hdr, 1);
+  for (std::size_t i = 0; i < ranges.size(); ++i) {
+    IndexRange range(ranges[i].first, ranges[i].second);
+    write_section(buffer, layout.ranges, &range, 1, i);
+  }
+  write_section(buffer, layout.shape_keys, graph.shape_keys().data(), n);
+  write_section(buffer, layout.vertices, vertices.values().data(), n);
+
+  std::uint32_t run_start = 0;
+  for (Index i = 0; i < n; ++i) {
+    auto run = vertices.continuation_of(i);
+    write_section(buffer, layout.run_starts, &run_start, 1, i);
+    write_section(buffer, layout.records, run.data(), run.size(), run_start);
+    run_start += run.size();
+  }
+  write_section(buffer, layout.run_starts, &run_start, 1, n);
+
+  for (Index i = 0; i < n; ++i) {
+    auto * row = buffer.data() + layout.rows + i * hdr.row_words;
+    for (Index j = 0; j < n; ++j) {
+      if (graph.has_edge(i, j)) {
+        row[j / WordBits] |= Word(1) << (j % WordBits);
+      }
+    }
+  }
+  write_section(buffer, layout.name, graph.level_name().data(),
+                hdr.name_length);
+  return buffer;
+}
+
+FrozenGraph::FrozenGraph(Graph const & graph, bool with_name)
+    : FrozenGraph(pack(graph, with_name)) {
+}
+
+FrozenGraph::FrozenGraph(std::vector<Word> && buffer)
+    : FrozenGraphView(buffer), buffer_(std::move(buffer)) {
+}
+
+FrozenGraph
+FrozenGraph::from_words(WordSpan words) {
+  FrozenGraphView view(words);
+  return FrozenGraph(std::vector<Word>(view.words().begin(),
+                                       view.words().end()));
+}
+
+FrozenGraph::FrozenGraph(FrozenGraph const & other)
+    : FrozenGraph(std::vector<Word>(other.words_.begin(), other.words_.end())) {
+}
+
+FrozenGraph::FrozenGraph(FrozenGraph && other) noexcept
+    : FrozenGraphView(std::exchange(static_cast<FrozenGraphView &>(other), {})),
+      buffer_(std::move(other.buffer_)) {
+}
+
+FrozenGraph &
+FrozenGraph::operator=(FrozenGraph other) noexcept {
+  static_cast<FrozenGraphView &>(*this) =
+      std::exchange(static_cast<FrozenGraphView &>(other), {});
+  buffer_ = std::move(other.buffer_);
+  return *this;
+}
@@ -0,0 +1,182 @@
+#pragma once
+
+#include "Fingerprint.hpp"
+#include "Graph.hpp"
+#include "Vertex.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <span>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+// A finished Graph packed into one contiguous, immutable buffer of 64-bit
+// words, for keeping and scanning a whole corpus of levels:
+//
+//  header | ranges | shape keys | vertices | run starts | records | rows | name
+//
+// Each section starts on a word boundary and padding is zeroed, so two frozen
+// copies of the same graph are equal byte for byte. The buffer holds no
+// pointers, so it can be memcpy'd, hashed as a block, written to a file and
+// mmap'd back. Matrix rows are bitsets, one bit per vertex. The level name is
+// optional.
+//
+// FrozenGraphView reads a buffer it doesn't own (such as a mapped file), and
+// FrozenGraph owns its buffer; both compare with isomorphism::check directly,
+// against each other or against a Graph.
+
+class FrozenGraphView {
+public:
+  using Word       = std::uint64_t;
+  using Index      = int;
+  using IndexRange = std::pair<std::int32_t, std::int32_t>;
+  using ShapeKey   = Graph::ShapeKey;
+  using VertexSpan = std::span<vertex::Vertex const>;
+  using WordSpan   = std::span<Word const>;
+
+  static constexpr std::uint32_t Magic   = 0x4746474c; // "LGFG"
+  static constexpr std::uint16_t Version = 1;
+
+  struct Header {
+    std::uint32_t magic;
+    std::uint16_t version;
+    std::uint16_t vertex_bytes; // sizeof(vertex::Vertex) of the writer
+    std::uint32_t num_vertices;
+    std::uint32_t num_ranges;
+    std::uint32_t num_records;
+    std::uint32_t row_words;
+    std::uint32_t name_length;
+    std::uint32_t num_words; // the whole buffer, header included
+  };
+
+  // empty; only good for assigning to
+  FrozenGraphView() = default;
+
+  // words must start with a frozen graph. Throws std::runtime_error if the
+  // header is not one this build wrote (wrong magic, version or vertex
+  // layout), or describes more words than there are or rows of the wrong
+  // length, or if the run starts don't ascend to the number of records, or
+  // the permutable ranges aren't ascending ranges of its vertices. Nothing
+  // else is checked.
+  explicit FrozenGraphView(WordSpan words);
+
+  int
+  size() const {
+    return header().num_vertices;
+  }
+
+  vertex::Vertex
+  vertex_at(Index idx) const {
+    return section<vertex::Vertex>(layout_.vertices)[idx];
+  }
+
+  VertexSpan
+  packed_vertices() const {
+    return {section<vertex::Vertex>(layout_.vertices), header().num_vertices};
+  }
+
+  VertexSpan continuation_of(Index idx) const;
+
+  bool
+  has_edge(Index from, Index to) const {
+    Word row_word =
+        words_[layout_.rows + from * header().row_words + to / WordBits];
+    return (row_word >> (to % WordBits)) & 1;
+  }
+
+  std::span<IndexRange const>
+  permutable_block_ranges() const {
+    return {section<IndexRange>(layout_.ranges), header().num_ranges};
+  }
+
+  std::span<ShapeKey const>
+  shape_keys() const {
+    return {section<ShapeKey>(layout_.shape_keys), header().num_vertices};
+  }
+
+  // empty if frozen without its name
+  std::string_view
+  level_name() const {
+    return {section<char>(layout_.name), header().name_length};
+  }
+
+  // the whole buffer, to write out or copy
+  WordSpan
+  words() const {
+    return words_;
+  }
+
+  bool check_isomorphism(FrozenGraphView const & other) const;
+  bool check_isomorphism(Graph const & other) const;
+
+  // equal to Graph::fingerprint() of the graph that was frozen
+  fingerprint::Hash fingerprint() const;
+
+  // A hash of the buffer itself, for finding exact duplicates: graphs frozen
+  // from identical Graphs hash (and compare) equal.
+  std::uint64_t hash() const;
+
+  bool operator==(FrozenGraphView const & other) const;
+
+protected:
+  static constexpr int WordBits = 64;
+
+  // word offset of each section
+  struct Layout {
+    std::uint64_t ranges;
+    std::uint64_t shape_keys;
+    std::uint64_t vertices;
+    std::uint64_t run_starts;
+    std::uint64_t records;
+    std::uint64_t rows;
+    std::uint64_t name;
+    std::uint64_t num_words;
+  };
+
+  static Layout layout_of(Header const & header);
+
+  Header const &
+  header() const {
+    return *reinterpret_cast<Header const *>(words_.data());
+  }
+
+  template <typename T>
+  T const *
+  section(std::uint64_t offset) const {
+    return reinterpret_cast<T const *>(words_.data() + offset);
+  }
+
+  WordSpan words_;
+  Layout   layout_{};
+};
+
+class FrozenGraph : public FrozenGraphView {
+public:
+  // Packs graph into a single allocation, dropping its name if asked.
+  explicit FrozenGraph(Graph const & graph, bool with_name = true);
+
+  // A copy of the frozen graph at the start of words, validated as
+  // FrozenGraphView does.
+  static FrozenGraph from_words(WordSpan words);
+
+  FrozenGraph(FrozenGraph const & other);
+  FrozenGraph(FrozenGraph && other) noexcept;
+  FrozenGraph & operator=(FrozenGraph other) noexcept;
+
+private:
+  explicit FrozenGraph(std::vector<Word> && buffer);
+
+  static std::vector<Word> pack(Graph const & graph, bool with_name);
+
+  std::vector<Word> buffer_;
+};
+
+template <>
+struct std::hash<FrozenGraph> {
+  std::size_t
+  operator()(FrozenGraph const & graph) const {
+    return graph.hash();
+  }
+};
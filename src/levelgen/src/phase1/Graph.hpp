@@ -1,11 +1,15 @@
 #pragma once
 #include "AdjacencyMatrix.hpp"
 #include "Color.hpp"
+#include "Fingerprint.hpp"
+#include "Isomorphism.hpp"
+#include "MinHash.hpp"
 #include "Vertices.hpp"
 #include "Vertex.hpp"
 
 #include <array>
 #include <algorithm>
+#include <memory_resource>
 #include <vector>
 
 class Graph {
@@ -13,24 +17,70 @@ class Graph {
 public:
   using Vertex              = vertex::Vertex;
   using Index               = int;
-  using IndexVec            = std::vector<Index>;
+  using IndexVec            = std::pmr::vector<Index>;
   using IndexRange          = std::pair<Index, Index>;
-  using IndexRangeVec       = std::vector<IndexRange>;
+  using IndexRangeVec       = std::pmr::vector<IndexRange>;
   using AdjacencyMatrix     = matrix::AdjacencyMatrix;
   using Block               = block::FinalBlock;
-  using BlockEquivalenceMap = Block[16];
+  using BlockEquivalenceMap = isomorphism::BlockEquivalenceMap;
+  using Feature             = minhash::Feature;
+  using FeatureVec          = minhash::FeatureVec;
+  using ShapeKey            = std::uint16_t;
+  using ShapeKeyVec         = std::pmr::vector<ShapeKey>;
 
+  static constexpr int DefaultWLIterations = 3;
+
+  // Everything the graph derives from its vertices is allocated from their
+  // memory resource too. Copying a graph puts the copy on the default
+  // resource, which is how to keep one built in a short-lived arena.
   Graph(Vertices && vertices, matrix::AdjacencyMatrix && adjacency_matrix,
         std::string level_name = "unspecified")
       : level_name_(std::move(level_name)),
-        adjacency_matrix_(adjacency_matrix),
-        vertices_(vertices),
-        indices_(vertices.size()) {
+        permutable_block_ranges_(vertices.resource()),
+        shape_keys_(vertices.resource()),
+        adjacency_matrix_(std::move(adjacency_matrix)),
+        vertices_(std::move(vertices)),
+        indices_(vertices_.size(), vertices_.resource()) {
     populate_colorgroups();
+    populate_shape_keys();
   }
 
   bool check_isomorphism(Graph const & other) const;
 
+  // Weisfeiler-Lehman subtree features: each vertex starts with a label from
+  // its color, start bit and block pattern, and each iteration relabels it
+  // with a hash of its own label plus the sorted labels of its children and
+  // of its parents. The result is the sorted set of every label seen (with
+  // repeats numbered, so it models a multiset). Isomorphic graphs produce
+  // identical features, and graphs differing by a rule share most of them.
+  FeatureVec wl_features(int iterations = DefaultWLIterations) const;
+
+  // A hash of everything about a single vertex that survives the relabeling
+  // check_isomorphism allows: color, start bit, size, and (for colors with
+  // dynamic blocks) only the pattern of repeated blocks rather than values.
+  static Feature invariant_label(Vertex vertex);
+
+  // invariant_label of a vertex along with its continuation records
+  static Feature invariant_label(Vertices const & vertices, Index idx);
+
+  // An isomorphism invariant of the whole graph, computed the same way as
+  // StaticGraph::fingerprint (see Fingerprint.hpp).
+  fingerprint::Hash fingerprint() const;
+
+  // MinHash of wl_features(), for near-duplicate search (see LshIndex)
+  minhash::Signature
+  minhash_signature(int iterations = DefaultWLIterations) const {
+    return minhash::compute(wl_features(iterations));
+  }
+
+  // The color, start bit and size of every vertex, one key each, sorted.
+  // Isomorphic graphs must have equal keys, which makes this a cheap way to
+  // rule most pairs out before searching for a vertex mapping.
+  ShapeKeyVec const &
+  shape_keys() const {
+    return shape_keys_;
+  }
+
   IndexRangeVec const &
   permutable_block_ranges() const {
     return permutable_block_ranges_;
@@ -41,6 +91,32 @@ public:
     return vertices_;
   };
 
+  // What isomorphism::check needs of a graph (see Isomorphism.hpp)
+  int
+  size() const {
+    return vertices_.size();
+  }
+
+  Vertex
+  vertex_at(Index idx) const {
+    return vertices_[idx];
+  }
+
+  Vertices::VertexSpan
+  packed_vertices() const {
+    return vertices_.values();
+  }
+
+  Vertices::VertexSpan
+  continuation_of(Index idx) const {
+    return vertices_.continuation_of(idx);
+  }
+
+  bool
+  has_edge(Index from, Index to) const {
+    return adjacency_matrix_.has_edge(from, to);
+  }
+
   void dump(char const *) const;
 
   std::string const &
@@ -60,12 +136,13 @@ public:
 
 private:
   void populate_colorgroups();
+  void populate_shape_keys();
   void append_colorgroup(Index from, Index to);
-  bool equivalent_adjacency_matricies(Graph const & other) const;
 
 private:
   std::string     level_name_;
   IndexRangeVec   permutable_block_ranges_;
+  ShapeKeyVec     shape_keys_;
   AdjacencyMatrix adjacency_matrix_;
   Vertices        vertices_;
 
@@ -91,6 +168,14 @@ visit_permutable_ranges(CallbackT cb, GraphT const &... graphs) {
   return minsize == maxsize;
 }
 
+// Calls back with each index outside the permutable block ranges of graph1,
+// which (being outside them) is the same vertex position in every graph.
+template <typename CallbackT>
+void
+visit_nonpermutable_indices(CallbackT cb, Graph const & graph1) {
+  isomorphism::visit_fixed_indices(cb, graph1);
+}
+
 // Takes N graphs, makes callbacks passing N corresponding vertices from each
 // graph to callback, each outside the permutable block ranges.
 //
@@ -100,19 +185,10 @@ template <typename CallbackT, typename... GraphT>
 void
 visit_nonpermutable_vertices(CallbackT cb, Graph const & graph1,
                              GraphT const &... graphs) {
-  Graph::Index idx = 0;
-  for (auto [begin_idx, end_idx] : graph1.permutable_block_ranges()) {
-    while (idx != begin_idx) {
-      cb(graph1.vertices().values()[idx], graphs.vertices().values()[idx]...);
-      idx++;
-    }
-    // jump to start of next nonpermutable range
-    idx = end_idx;
-  }
-  // Visit the rest...
-  auto end_idx = graph1.vertices().size();
-  while (idx != end_idx) {
-    cb(graph1.vertices().values()[idx], graphs.vertices().values()[idx]...);
-    idx++;
-  }
+  visit_nonpermutable_indices(
+      [&](Graph::Index idx) {
+        cb(graph1.vertices().values()[idx],
+           graphs.vertices().values()[idx]...);
+      },
+      graph1);
 }
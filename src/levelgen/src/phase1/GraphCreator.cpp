@@ -1,15 +1,23 @@
 #include "GraphCreator.hpp"
+#include "ChainWalk.hpp"
 #include "Color.hpp"
+#include "RunMerge.hpp"
 #include "Transforms.hpp"
 #include "Vertices.hpp"
 #include <boost/json.hpp>
 
 #include "AdjacencyMatrixPrinter.hpp"
 
+#include <algorithm>
 #include <cassert>
+#include <deque>
 #include <fstream>
 #include <iostream>
 #include <iterator>
+#include <map>
+#include <memory_resource>
+#include <numeric>
+#include <set>
 #include <stdexcept>
 #include <string>
 
@@ -54,26 +62,16 @@ using namespace std::literals;
 
 */
 
-static void
-install_override_transforms(json::object const & type_overrides,
-                            Transforms &         transforms) {
-  for (auto const & [ch, type_override] : type_overrides) {
-    if (size(ch) > 1) {
-      throw std::runtime_error(
-          "Invalid type override, expecting char key, got: " + std::string(ch));
-    }
-    json::object const & type_config = type_override.as_object();
-    assert(ch.size() == 1);
-    transforms.add_level_type_override(ch[0], type_config);
-  }
-}
-
-GraphCreator::GraphCreator(boost::json::object const & level_obj) {
+GraphCreator::GraphCreator(boost::json::object const & level_obj,
+                           std::pmr::memory_resource * resource)
+    : GraphCreator(resource) {
   if (auto * name_val = level_obj.if_contains("name")) {
     level_name_ = name_val->as_string();
   }
   if (auto * type_overrides_val = level_obj.if_contains("type_overrides")) {
-    install_override_transforms(type_overrides_val->as_object(), transforms_);
+    for (auto const & [ch, type_override] : type_overrides_val->as_object()) {
+      add_type_override(ch, type_override.as_object());
+    }
   }
 
   if (auto * rules_val = level_obj.if_contains("rules")) {
@@ -84,101 +82,278 @@ GraphCreator::GraphCreator(boost::json::object const & level_obj) {
   }
 }
 
+GraphCreator::GraphCreator(std::pmr::memory_resource * resource)
+    : resource_(resource), vertices_(resource) {
+}
+
+void
+GraphCreator::set_level_name(std::string_view name) {
+  level_name_ = name;
+}
+
+void
+GraphCreator::add_type_override(std::string_view            block,
+                                boost::json::object const & type_config) {
+  if (size(block) != 1) {
+    throw std::runtime_error(
+        "Invalid type override, expecting char key, got: " +
+        std::string(block));
+  }
+  transforms_.add_level_type_override(block[0], type_config);
+}
+
 Graph
 GraphCreator::create() {
-  return Graph(
-      std::move(vertices_), std::move(*adjacency_matrix_), level_name_);
+  return Graph(std::move(vertices_),
+               std::move(*adjacency_matrix_),
+               std::move(level_name_));
 }
 
 // A chain of blocks, such as "a -> bcc", then "a" or "bcc" would be a chain,
 // that get translated, and put into vertices, like [a] -> [b] -> [c] -> [c]
-// This will either create the vertices or add edges between them (if they've
-// already been created), depending on the traverse action.
+// This creates the vertices (or finds them, if already added) and records the
+// edges between them.
+//
+// A vertex is identified by the chain suffix it starts, so "bcc" and a later
+// "cc" share their last two vertices. Suffixes are found in the reversed
+// suffix trie, walking the chain back to front, rather than by name, so this
+// is linear in the chain length. The chain text is stored in the vertex name
+// arena at most once, and every new vertex's name is a slice of it. The walk
+// itself is chain_walk::walk, which StaticGraph builds with too.
 int
 GraphCreator::process_chain(json::string_view chain, RuleSide side,
-                            int prev_idx, GraphCreator::TraverseAction action) {
-  if (chain.empty()) {
-    assert(side == RuleSide::TO); // no empty chains on the left
-    chain = block::NOTHING_BLOCK_CSTR;
+                            int prev_idx, RulesState & state) {
+  assert(not chain.empty() || side == RuleSide::TO); // none on the left
+  auto const text = chain_walk::nonempty({chain.data(), chain.size()});
+
+  int const len         = text.size();
+  auto &    chain_tails = state.chain_tails;
+  chain_tails.resize(len);
+  for (int i = len - 1, tail = SuffixTrie::Root; i >= 0; --i) {
+    auto color = transforms_.to_color(text[i], side);
+    tail = chain_tails[i] = state.tails.extend(tail, text[i], color);
   }
-  auto len = chain.size();
-  int  idx;
-  bool first = true;
-  for (char const & ch : chain) {
-    auto vertex_id      = std::string_view(&ch, len--);
-    auto [block, color] = transforms_.do_transform(vertex_id, side);
-
-    // creates, or if already added, returns the existing index.
-    auto role = side == RuleSide::FROM && first ? vertex::VertexRole::START
-                                                : vertex::VertexRole::INTERNAL;
-    idx       = vertices_.add_vertex_single(vertex_id, block, color, role);
-    first     = false;
-
-    if (action == TraverseAction::CREATE_EDGES) {
-      assert(adjacency_matrix_.has_value());
-      if (prev_idx != -1) {
-        adjacency_matrix_->add_edge(prev_idx, idx);
+  state.vertex_of_tail.resize(state.tails.size(), -1);
+
+  // a vertex per distinct (block, color) suffix, named by the chain's text,
+  // which is only stored once one of its suffixes is new
+  struct Builder {
+    GraphCreator &               creator;
+    RulesState &                 state;
+    std::string_view             text;
+    RuleSide                     side;
+    std::optional<std::uint32_t> chain_text;
+
+    int
+    find_vertex(int i) const {
+      return state.vertex_of_tail[state.chain_tails[i]];
+    }
+
+    int
+    add_vertex(int i, vertex::VertexRole role) {
+      auto & vertices = creator.vertices_;
+      if (not chain_text) {
+        chain_text = vertices.add_name_text(text);
+      }
+      auto suffix         = text.substr(i);
+      auto [block, color] = creator.transforms_.do_transform(suffix, side);
+
+      int idx = vertices.append_vertex(*chain_text + i, suffix.size(), block,
+                                       color, role);
+      state.vertex_of_tail[state.chain_tails[i]] = idx;
+      return idx;
+    }
+
+    void
+    mark_start(int idx) {
+      auto & vertices = creator.vertices_;
+      if (get_start_bit(vertices[idx]) == false) {
+        vertices.set_vertex(idx, set_start_bit(vertices[idx]));
       }
-      prev_idx = idx;
     }
+
+    void
+    add_edge(int from_idx, int to_idx) {
+      state.edges.emplace_back(from_idx, to_idx);
+    }
+  };
+
+  Builder builder{*this, state, text, side, std::nullopt};
+  return chain_walk::walk(builder, text, side, prev_idx);
+}
+
+void
+GraphCreator::begin_rules() {
+  rules_.emplace(resource_);
+}
+
+void
+GraphCreator::add_from_chain(std::string_view chain) {
+  rules_->from_idx = process_chain(chain, RuleSide::FROM, -1, *rules_);
+}
+
+// Each to chain follows the rule's from chain, not the previous to chain:
+// "a"->["b", "c"], then "a" is the prev of both "b" and "c"
+void
+GraphCreator::add_to_chain(std::string_view chain) {
+  assert(rules_->from_idx != -1);
+  process_chain(chain, RuleSide::TO, rules_->from_idx, *rules_);
+}
+
+// Each chain is transformed and looked up only once; its edges are kept
+// aside until all the vertices exist and the matrix can be sized.
+void
+GraphCreator::finish_rules() {
+  if (not rules_) {
+    throw std::runtime_error("Level does not contain rules");
+  }
+  adjacency_matrix_.emplace(vertices_.names_size(), resource_);
+  for (auto [from_idx, to_idx] : rules_->edges) {
+    adjacency_matrix_->add_edge(from_idx, to_idx);
   }
-  return idx;
+  rules_.reset();
 }
 
 // for each from/to rule, process both the "from" chain, and the "to" chains
 void
-GraphCreator::traverse_input(json::object const &         rules,
-                             GraphCreator::TraverseAction action) {
+GraphCreator::add_rules(json::object const & rules) {
+  begin_rules();
+  rules_->edges.reserve(2 * rules.size());
   for (auto const & [from, to] : rules) {
-    int prev_idx = process_chain(from, RuleSide::FROM, -1, action);
-
-    // Each chain's prev_idx is from above; do NOT update it in the loop.
-    // "a"->["b", "c"], then "a" is the prev of both "b" and "c"
-    for (json::value to : to.as_array()) {
-      process_chain(to.as_string(), RuleSide::TO, prev_idx, action);
+    add_from_chain(from);
+    for (json::value const & to_chain : to.as_array()) {
+      add_to_chain(to_chain.as_string());
     }
   }
+  finish_rules();
 }
 
-void
-GraphCreator::add_rules(json::object const & rules) {
-  traverse_input(rules, TraverseAction::CREATE_VERTEX_ONLY);
+// The graph run_merge::merge_runs works on: the vertices and matrix as built.
+struct GraphCreator::Merger {
+  GraphCreator & creator;
 
-  // must know the number of vertices before we can size the adj matrix, so must
-  // be after the CREATE_VERTEX_ONLY step
-  adjacency_matrix_.emplace(vertices_.names_size());
-  traverse_input(rules, TraverseAction::CREATE_EDGES);
-}
+  int
+  size() const {
+    return creator.vertices_.size();
+  }
+
+  template <typename CallbackT>
+  int
+  visit_parents_of(int idx, CallbackT cb) const {
+    return creator.adjacency_matrix_->visit_parents_of(idx, cb);
+  }
+
+  template <typename CallbackT>
+  void
+  visit_children_of(int idx, CallbackT cb) const {
+    creator.adjacency_matrix_->visit_children_of(idx, cb);
+  }
+
+  bool
+  try_to_merge(int from_idx, int to_idx) {
+    return creator.try_to_merge(from_idx, to_idx);
+  }
+};
 
 // optimize to reduce number of vertices once the whole graph is known. Attempts
 // to merge adjacent connected vertices 'a' and 'b' if 'a' is the only parent.
+// StaticGraph compresses with the same run_merge::merge_runs.
 GraphCreator &
 GraphCreator::compress_vertices() {
   assert(adjacency_matrix_->size() == vertices_.size());
 
-  bool something_changed;
-  do {
-    something_changed = false;
+  std::pmr::deque<int>   worklist(resource_);
+  std::pmr::vector<bool> queued(vertices_.size(), false, resource_);
+  Merger                 merger{*this};
+  run_merge::merge_runs(merger, worklist, queued);
+  adjacency_matrix_->resize_down(vertices_.size());
 
-    for (int cur_idx = 0, sz = vertices_.size(); cur_idx < sz;) {
-      int source_idx;
-      int indegree = adjacency_matrix_->visit_parents_of(
-          cur_idx, [&](int src_idx) { source_idx = src_idx; });
-      if (indegree == 1) {
-        something_changed |= try_to_merge(source_idx, cur_idx);
-      }
+  return *this;
+}
 
-      // if vertex merged away, new node took its place
-      if (vertices_.size() < sz) {
-        sz--;
-      }
-      else {
-        cur_idx++;
-      }
+// Partition refinement: start with vertices grouped by their value alone, then
+// keep splitting groups whose members point into different sets of groups,
+// until a round splits nothing. Each group then becomes one vertex.
+GraphCreator &
+GraphCreator::minimize_vertices() {
+  using IndexVec  = std::pmr::vector<int>;
+  using Signature = std::pair<int, IndexVec>;
+
+  int const sz = vertices_.size();
+  IndexVec  group(sz, resource_);
+  int       num_groups = 0;
+  {
+    using Value = std::pair<vertex::Vertex, Vertices::VertexVec>;
+    std::pmr::map<Value, int> by_value(resource_);
+    for (int idx = 0; idx < sz; ++idx) {
+      auto  run = vertices_.continuation_of(idx);
+      Value value{vertices_[idx], {run.begin(), run.end(), resource_}};
+      auto [iter, _] = by_value.try_emplace(std::move(value), by_value.size());
+      group[idx]     = iter->second;
     }
-  } while (something_changed);
-  adjacency_matrix_->resize_down(vertices_.size());
+    num_groups = by_value.size();
+  }
 
+  for (;;) {
+    std::pmr::map<Signature, int> by_signature(resource_);
+    IndexVec                      next_group(sz, resource_);
+    for (int idx = 0; idx < sz; ++idx) {
+      Signature sig{group[idx], IndexVec(resource_)};
+      adjacency_matrix_->visit_children_of(
+          idx, [&](int child_idx) { sig.second.push_back(group[child_idx]); });
+      std::sort(begin(sig.second), end(sig.second));
+      sig.second.erase(std::unique(begin(sig.second), end(sig.second)),
+                       end(sig.second));
+      auto [iter, _]  = by_signature.try_emplace(std::move(sig),
+                                                by_signature.size());
+      next_group[idx] = iter->second;
+    }
+    group = std::move(next_group);
+    // groups only ever split, so an unchanged count means nothing split
+    if (std::ssize(by_signature) == num_groups) {
+      break;
+    }
+    num_groups = by_signature.size();
+  }
+
+  if (num_groups == sz) {
+    return *this;
+  }
+
+  // the lowest index in each group stands for it
+  IndexVec keeper(num_groups, -1, resource_);
+  for (int idx = 0; idx < sz; ++idx) {
+    if (keeper[group[idx]] == -1) {
+      keeper[group[idx]] = idx;
+    }
+  }
+
+  std::pmr::set<std::pair<int, int>> group_edges(resource_);
+  for (int idx = 0; idx < sz; ++idx) {
+    adjacency_matrix_->visit_children_of(idx, [&](int child_idx) {
+      group_edges.emplace(group[idx], group[child_idx]);
+    });
+  }
+
+  // Drop the others, highest first. Each removal moves the current last vertex
+  // into the hole, so track where every original vertex now lives.
+  IndexVec now_at(sz, resource_), holds(sz, resource_);
+  std::iota(begin(now_at), end(now_at), 0);
+  std::iota(begin(holds), end(holds), 0);
+  for (int idx = sz - 1; idx >= 0; --idx) {
+    if (keeper[group[idx]] != idx) {
+      int moved_idx = vertices_.remove_vertex(now_at[idx]);
+      int hole      = now_at[idx];
+      holds[hole]   = holds[moved_idx];
+      now_at[holds[hole]] = hole;
+    }
+  }
+
+  adjacency_matrix_.emplace(num_groups, resource_);
+  for (auto [from_group, to_group] : group_edges) {
+    adjacency_matrix_->add_edge(now_at[keeper[from_group]],
+                                now_at[keeper[to_group]]);
+  }
   return *this;
 }
 
@@ -201,24 +376,17 @@ GraphCreator::try_to_merge(int from_idx, int to_idx) {
   vertex::Vertex from_vtx = vertices_[from_idx];
   vertex::Vertex to_vtx   = vertices_[to_idx];
 
-  bool something_changed = false;
-
-  if (vertex::vertices_are_mergeable(from_vtx, to_vtx)) {
-    vertex::Vertex merged_vtx = create_merged(from_vtx, to_vtx);
-    if (merged_vtx != from_vtx) {
-      something_changed = true;
-      int  num_merged   = num_can_merge(from_vtx, to_vtx);
-      auto to_vtx2      = pop_front(to_vtx, num_merged);
-      vertices_.set_vertex(from_idx, merged_vtx);
-      if (size(to_vtx2) == 0) {
-        remove_vertex(to_idx, from_idx);
-      }
-      else {
-        vertices_.set_vertex(to_idx, to_vtx2);
-      }
-    }
+  if (from_idx == to_idx ||
+      not vertex::vertices_are_mergeable(from_vtx, to_vtx)) {
+    return false;
   }
-  return something_changed;
+
+  // Blocks that don't fit in the from vertex go to its continuation rather
+  // than staying behind in to, so a same-color run always ends up whole in
+  // one vertex.
+  vertices_.append_run(from_idx, to_idx);
+  remove_vertex(to_idx, from_idx);
+  return true;
 }
 
 void
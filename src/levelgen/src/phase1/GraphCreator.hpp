@@ -3,26 +3,56 @@
 #include "AdjacencyMatrixPrinter.hpp"
 #include "Graph.hpp"
 #include "RuleSide.hpp"
+#include "SuffixTrie.hpp"
 #include "Transforms.hpp"
 #include "Vertex.hpp"
 #include "Vertices.hpp"
 
 #include <boost/json.hpp>
+#include <memory_resource>
 #include <optional>
+#include <string_view>
+#include <utility>
 #include <vector>
 
-namespace vertex {
-enum class Vertex : std::uint32_t;
-}
-
 class GraphCreator {
   using VertexVec = std::vector<vertex::Vertex>;
 
 public:
   using const_iterator = typename VertexVec::const_iterator;
 
-  GraphCreator(boost::json::object const & level);
-
+  // Vertices, the adjacency matrix and all the scratch space used while
+  // building come from resource. A loop trying many candidate levels can give
+  // each one a std::pmr::monotonic_buffer_resource and release it in one go,
+  // copying out (onto the default resource) only the graphs it keeps.
+  GraphCreator(boost::json::object const & level,
+               std::pmr::memory_resource * resource =
+                   std::pmr::get_default_resource());
+
+  // An empty level, to be filled in piece by piece by something that reads
+  // it as a stream rather than an object (see LevelParser): name and type
+  // overrides first, then begin_rules(), each rule's from chain followed by
+  // its to chains, and finish_rules(). Chains are only read during the call,
+  // so they may point into a parser's buffer.
+  explicit GraphCreator(std::pmr::memory_resource * resource =
+                            std::pmr::get_default_resource());
+
+  void set_level_name(std::string_view name);
+
+  // block must be a single char; throws std::runtime_error otherwise
+  void add_type_override(std::string_view            block,
+                         boost::json::object const & type_config);
+
+  void begin_rules();
+  void add_from_chain(std::string_view chain);
+  void add_to_chain(std::string_view chain);
+
+  // Sizes the adjacency matrix and adds the edges found. Throws
+  // std::runtime_error if begin_rules() was never called.
+  void finish_rules();
+
+  // Moves the vertices, matrix and name into the Graph, leaving this creator
+  // empty; call it last. The Graph keeps using the creator's resource.
   Graph create();
 
   Vertices const &
@@ -54,9 +84,9 @@ public:
   // used with:
   // * to_string(XXX);
   // operator<< (std::ostream&, XXX);
-  matrix::WithNames
+  matrix::WithVertices
   get_pretty_adjacency_matrix() const {
-    return {*adjacency_matrix_, vertices_.names()};
+    return {*adjacency_matrix_, vertices_};
   }
 
   bool
@@ -65,12 +95,20 @@ public:
   }
 
   // when two vertices are adjacent, and have the same color, and there is only
-  // one edge into the given "target" vertex, and there is room in the "from"
-  // vertex of that edge, then merge them together into the same node, making it
-  // a multi-block vertex.  (The graph cannot be created merged, because
-  // we don't know where the edges until its construction has completed.)
+  // one edge into the given "target" vertex, then merge them together into the
+  // same node, making it a multi-block vertex. Blocks past what the "from"
+  // vertex holds go into its continuation (see Vertices::continuation_of).
+  // (The graph cannot be created merged, because we don't know where the edges
+  // until its construction has completed.)
   GraphCreator & compress_vertices();
 
+  // Optional, and best done after compress_vertices: merge vertices that are
+  // indistinguishable from the outside, i.e. the same color, blocks and start
+  // bit, with children that are pairwise equivalent in turn. Compressed chains
+  // spelled differently in the rules can end up equal this way, which the
+  // suffix-name sharing done during construction can't see.
+  GraphCreator & minimize_vertices();
+
   // at any time (either before or after compression, though it mostly only
   // makes sense out of doing it _after_ compression) we can sort the vertices
   // such that all of the same color are adjacent. This will also update the
@@ -80,24 +118,45 @@ public:
 private:
   void add_rules(boost::json::object const & rules);
 
-  enum class TraverseAction { CREATE_VERTEX_ONLY, CREATE_EDGES };
-  void traverse_input(boost::json::object const & rules, TraverseAction action);
+  // Edges found while reading the rules, before the vertex count (and so the
+  // adjacency matrix size) is known.
+  using Edge     = std::pair<int, int>;
+  using EdgeList = std::pmr::vector<Edge>;
+
+  // Everything needed while reading the rules, and dropped after.
+  struct RulesState {
+    explicit RulesState(std::pmr::memory_resource * resource)
+        : edges(resource),
+          tails(resource),
+          vertex_of_tail(resource),
+          chain_tails(resource) {
+    }
+
+    EdgeList              edges;
+    SuffixTrie            tails;
+    std::pmr::vector<int> vertex_of_tail; // by trie node, -1 if none yet
+    std::pmr::vector<int> chain_tails;    // scratch, per chain
+    int                   from_idx = -1;  // last vertex of the rule's from
+  };
 
   // return idx of last vertex in chain
   int process_chain(boost::json::string_view chain, RuleSide side, int prev_idx,
-                    TraverseAction action);
+                    RulesState & state);
 
   // while compressing vertices, we found two elgible vertices to merge. Do so
   // if possible.
 
   bool try_to_merge(int from_idx, int to_idx);
+  struct Merger; // try_to_merge and the matrix, for run_merge::merge_runs
   void remove_vertex(int doomed_idx, int parent_idx);
   void give_vertex_children_to_parent(int vertex_idx, int parent_idx);
   void vertex_moved(int old_idx, int new_idx);
 
 private:
+  std::pmr::memory_resource *            resource_;
   std::string                            level_name_;
   Transforms                             transforms_;
   Vertices                               vertices_;
   std::optional<matrix::AdjacencyMatrix> adjacency_matrix_;
+  std::optional<RulesState>              rules_; // between begin/finish_rules
 };
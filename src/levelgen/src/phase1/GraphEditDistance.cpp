@@ -0,0 +1,314 @@
+#include "GraphEditDistance.hpp"
+
+#include <algorithm>
+#include <cstdlib>
+#include <functional>
+#include <numeric>
+#include <unordered_map>
+#include <vector>
+
+namespace {
+
+constexpr int Deleted = -1;
+
+// Precomputed per-graph facts needed on every search step
+struct GraphInfo {
+  GraphInfo(Graph const & graph)
+      : am_(graph.adjacency_matrix()), size_(graph.vertices().size()) {
+    outdegree_.reserve(size_);
+    indegree_.reserve(size_);
+    for (int i = 0; i < size_; ++i) {
+      outdegree_.push_back(am_.outdegree_of(i));
+      indegree_.push_back(am_.indegree_of(i));
+    }
+  }
+
+  bool
+  has_edge(int from, int to) const {
+    return am_.has_edge(from, to);
+  }
+
+  matrix::AdjacencyMatrix const & am_;
+  int                             size_;
+  std::vector<int>                label_id_; // dense id of invariant_label
+  std::vector<int>                outdegree_;
+  std::vector<int>                indegree_;
+};
+
+class EditDistanceSearch {
+public:
+  EditDistanceSearch(Graph const & graph1, Graph const & graph2, int bound);
+
+  std::optional<int> run();
+
+private:
+  void search(int depth, int cost);
+
+  // cost of the vertex and of all edges between it and previously mapped
+  // vertices, if graph1's vertex order_[depth] is mapped to target (which may
+  // be Deleted)
+  int mapping_cost(int depth, int target) const;
+
+  // cost of inserting every graph2 vertex that was not used as a target
+  int insertion_cost() const;
+
+  // admissible estimate of the cost of mapping the remaining vertices
+  int lower_bound(int depth) const;
+  int label_lower_bound() const;
+  int degree_lower_bound(int depth) const;
+
+  void assign(int depth, int target);
+  void unassign(int depth, int target);
+
+private:
+  GraphInfo g1_;
+  GraphInfo g2_;
+  int       num_labels_ = 0;
+  int       bound_;
+  int       best_; // cheapest complete mapping so far, or bound_ + 1
+
+  std::vector<int>  order_;   // graph1 vertices, in the order they're mapped
+  std::vector<int>  mapping_; // graph1 vertex -> graph2 vertex, or Deleted
+  std::vector<bool> used_;    // graph2 vertex is already a mapping target
+
+  // number of unmapped vertices with each label, for each graph
+  std::vector<int> remaining1_;
+  std::vector<int> remaining2_;
+
+  // graph2 candidates to try for each label, same label first
+  std::vector<std::vector<int>> candidates_;
+
+  // scratch space for degree_lower_bound
+  mutable std::vector<int> degrees1_;
+  mutable std::vector<int> degrees2_;
+};
+
+EditDistanceSearch::EditDistanceSearch(Graph const & graph1,
+                                       Graph const & graph2, int bound)
+    : g1_(graph1),
+      g2_(graph2),
+      bound_(bound),
+      best_(bound + 1),
+      mapping_(g1_.size_, Deleted),
+      used_(g2_.size_, false) {
+  std::unordered_map<Graph::Feature, int> label_ids;
+  auto assign_labels = [&](Graph const & graph, GraphInfo & info) {
+    for (int i = 0; i < info.size_; ++i) {
+      auto label   = Graph::invariant_label(graph.vertices(), i);
+      auto [it, _] = label_ids.try_emplace(label, label_ids.size());
+      info.label_id_.push_back(it->second);
+    }
+  };
+  assign_labels(graph1, g1_);
+  assign_labels(graph2, g2_);
+  num_labels_ = label_ids.size();
+
+  remaining1_.resize(num_labels_);
+  remaining2_.resize(num_labels_);
+  for (int label : g1_.label_id_) {
+    ++remaining1_[label];
+  }
+  for (int label : g2_.label_id_) {
+    ++remaining2_[label];
+  }
+
+  // most constrained (highest degree) vertices first, so bad branches fail
+  // early
+  order_.resize(g1_.size_);
+  std::iota(begin(order_), end(order_), 0);
+  std::stable_sort(begin(order_), end(order_), [this](int a, int b) {
+    return g1_.outdegree_[a] + g1_.indegree_[a] >
+           g1_.outdegree_[b] + g1_.indegree_[b];
+  });
+
+  candidates_.resize(num_labels_);
+  for (int label = 0; label < num_labels_; ++label) {
+    auto & candidates = candidates_[label];
+    for (int v = 0; v < g2_.size_; ++v) {
+      if (g2_.label_id_[v] == label) {
+        candidates.push_back(v);
+      }
+    }
+    for (int v = 0; v < g2_.size_; ++v) {
+      if (g2_.label_id_[v] != label) {
+        candidates.push_back(v);
+      }
+    }
+  }
+}
+
+std::optional<int>
+EditDistanceSearch::run() {
+  if (lower_bound(0) < best_) {
+    search(0, 0);
+  }
+  if (best_ <= bound_) {
+    return best_;
+  }
+  return std::nullopt;
+}
+
+int
+EditDistanceSearch::mapping_cost(int depth, int target) const {
+  int const vertex = order_[depth];
+
+  if (target == Deleted) {
+    // the vertex, and every edge between it and a mapped vertex
+    int cost = 1 + g1_.has_edge(vertex, vertex);
+    for (int k = 0; k < depth; ++k) {
+      int other = order_[k];
+      cost += g1_.has_edge(vertex, other) + g1_.has_edge(other, vertex);
+    }
+    return cost;
+  }
+
+  int cost = g1_.label_id_[vertex] != g2_.label_id_[target];
+  cost += g1_.has_edge(vertex, vertex) != g2_.has_edge(target, target);
+  for (int k = 0; k < depth; ++k) {
+    int other        = order_[k];
+    int other_target = mapping_[other];
+    if (other_target == Deleted) {
+      cost += g1_.has_edge(vertex, other) + g1_.has_edge(other, vertex);
+    }
+    else {
+      cost += g1_.has_edge(vertex, other) !=
+              g2_.has_edge(target, other_target);
+      cost += g1_.has_edge(other, vertex) !=
+              g2_.has_edge(other_target, target);
+    }
+  }
+  return cost;
+}
+
+int
+EditDistanceSearch::insertion_cost() const {
+  int cost = 0;
+  for (int from = 0; from < g2_.size_; ++from) {
+    cost += not used_[from];
+    for (int to = 0; to < g2_.size_; ++to) {
+      if ((not used_[from] || not used_[to]) && g2_.has_edge(from, to)) {
+        ++cost;
+      }
+    }
+  }
+  return cost;
+}
+
+// Each unmapped vertex either gets a partner with the same label, or costs at
+// least 1 (relabel, delete, or insert).
+int
+EditDistanceSearch::label_lower_bound() const {
+  int unmapped1 = 0;
+  int unmapped2 = 0;
+  int matched   = 0;
+  for (int label = 0; label < num_labels_; ++label) {
+    unmapped1 += remaining1_[label];
+    unmapped2 += remaining2_[label];
+    matched += std::min(remaining1_[label], remaining2_[label]);
+  }
+  return std::max(unmapped1, unmapped2) - matched;
+}
+
+// Every edge touching an unmapped vertex is still to be paid for. Pairing up
+// the unmapped vertices of both graphs (missing partners have degree 0), the
+// degree difference of each pair needs at least that many edge edits, and
+// each edge edit changes at most one out-degree and one in-degree. Matching
+// sorted degree sequences minimizes the total difference over all pairings.
+int
+EditDistanceSearch::degree_lower_bound(int depth) const {
+  auto sequence_distance = [&](std::vector<int> const & deg1,
+                               std::vector<int> const & deg2) {
+    degrees1_.clear();
+    degrees2_.clear();
+    for (int k = depth; k < g1_.size_; ++k) {
+      degrees1_.push_back(deg1[order_[k]]);
+    }
+    for (int v = 0; v < g2_.size_; ++v) {
+      if (not used_[v]) {
+        degrees2_.push_back(deg2[v]);
+      }
+    }
+    auto const sz = std::max(degrees1_.size(), degrees2_.size());
+    degrees1_.resize(sz, 0);
+    degrees2_.resize(sz, 0);
+    std::sort(begin(degrees1_), end(degrees1_), std::greater<>{});
+    std::sort(begin(degrees2_), end(degrees2_), std::greater<>{});
+
+    int distance = 0;
+    for (std::size_t i = 0; i < sz; ++i) {
+      distance += std::abs(degrees1_[i] - degrees2_[i]);
+    }
+    return distance;
+  };
+
+  int total = sequence_distance(g1_.outdegree_, g2_.outdegree_) +
+              sequence_distance(g1_.indegree_, g2_.indegree_);
+  return (total + 1) / 2;
+}
+
+int
+EditDistanceSearch::lower_bound(int depth) const {
+  return label_lower_bound() + degree_lower_bound(depth);
+}
+
+void
+EditDistanceSearch::assign(int depth, int target) {
+  int vertex       = order_[depth];
+  mapping_[vertex] = target;
+  --remaining1_[g1_.label_id_[vertex]];
+  if (target != Deleted) {
+    used_[target] = true;
+    --remaining2_[g2_.label_id_[target]];
+  }
+}
+
+void
+EditDistanceSearch::unassign(int depth, int target) {
+  int vertex       = order_[depth];
+  mapping_[vertex] = Deleted;
+  ++remaining1_[g1_.label_id_[vertex]];
+  if (target != Deleted) {
+    used_[target] = false;
+    ++remaining2_[g2_.label_id_[target]];
+  }
+}
+
+void
+EditDistanceSearch::search(int depth, int cost) {
+  if (depth == g1_.size_) {
+    cost += insertion_cost();
+    if (cost < best_) {
+      best_ = cost;
+    }
+    return;
+  }
+
+  auto try_target = [&](int target) {
+    int next_cost = cost + mapping_cost(depth, target);
+    if (next_cost >= best_) {
+      return;
+    }
+    assign(depth, target);
+    if (next_cost + lower_bound(depth + 1) < best_) {
+      search(depth + 1, next_cost);
+    }
+    unassign(depth, target);
+  };
+
+  for (int target : candidates_[g1_.label_id_[order_[depth]]]) {
+    if (not used_[target]) {
+      try_target(target);
+    }
+  }
+  try_target(Deleted);
+}
+
+} // namespace
+
+std::optional<int>
+graph_edit_distance(Graph const & graph1, Graph const & graph2, int bound) {
+  if (bound < 0) {
+    return std::nullopt;
+  }
+  return EditDistanceSearch(graph1, graph2, bound).run();
+}
@@ -0,0 +1,22 @@
+#pragma once
+
+#include "Graph.hpp"
+
+#include <optional>
+
+// The graph edit distance is the minimum number of edits that turn graph1
+// into graph2, where an edit is one of:
+// * inserting or deleting a vertex
+// * relabeling a vertex (labels compared via Graph::invariant_label)
+// * inserting or deleting an edge
+//
+// Blocks are compared per vertex (by their pattern), not through one mapping
+// across the whole graph, so a distance of 0 is slightly more forgiving than
+// check_isomorphism.
+//
+// Returns the exact distance if it is at most bound, or nullopt if it is more
+// than bound. The search is branch-and-bound over vertex mappings, pruned by
+// lower bounds from the label histograms and degree sequences of the vertices
+// not yet mapped, so a small bound stays fast even for very different graphs.
+std::optional<int> graph_edit_distance(Graph const & graph1,
+                                       Graph const & graph2, int bound);
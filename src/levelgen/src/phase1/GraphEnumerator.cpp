@@ -0,0 +1,351 @@
+#include "GraphEnumerator.hpp"
+#include "AdjacencyMatrix.hpp"
+#include "Vertices.hpp"
+
+#include <algorithm>
+#include <numeric>
+#include <set>
+#include <stdexcept>
+#include <string>
+#include <tuple>
+
+namespace {
+
+bool
+has_single_block(color::FinalColor color) {
+  auto c = get_color(color);
+  return c == color::Color::NOTHING || c == color::Color::WILDCARD;
+}
+
+bool
+is_nothing(color::FinalColor color) {
+  return get_color(color) == color::Color::NOTHING;
+}
+
+constexpr std::uint8_t
+bit(int idx) {
+  return std::uint8_t(1u << idx);
+}
+
+} // namespace
+
+GraphEnumerator::GraphEnumerator(EnumerationConfig const & config)
+    : config_(config) {
+  if (config_.max_vertices < 1 || config_.max_vertices > MaxVertices) {
+    throw std::runtime_error("GraphEnumerator: max_vertices must be 1.." +
+                             std::to_string(MaxVertices));
+  }
+  constexpr int MaxBlocks = vertex::BlockMask;
+  if (config_.num_blocks < 1 || config_.num_blocks > MaxBlocks) {
+    throw std::runtime_error("GraphEnumerator: num_blocks must be 1.." +
+                             std::to_string(MaxBlocks));
+  }
+  if (config_.colors.empty()) {
+    throw std::runtime_error("GraphEnumerator: no colors given");
+  }
+  init_alphabet();
+  init_block_relabelings();
+}
+
+// Labels are ordered the same way Vertices::compute_sorted_index_map orders
+// single-block vertices (color, start bit, block), so a graph in canonical
+// order is already grouped by color.
+void
+GraphEnumerator::init_alphabet() {
+  using vertex::VertexRole;
+  for (auto color : config_.colors) {
+    int num_blocks = has_single_block(color) ? 1 : config_.num_blocks;
+    for (int b = 1; b <= num_blocks; ++b) {
+      auto block = block::FinalBlock(b);
+      alphabet_.push_back({color, block, VertexRole::INTERNAL});
+      if (has_from(color)) {
+        alphabet_.push_back({color, block, VertexRole::START});
+      }
+    }
+  }
+
+  auto key = [](Label const & label) {
+    return std::tuple(+label.color, +label.role, +label.block);
+  };
+  std::sort(begin(alphabet_), end(alphabet_), [&](auto & l1, auto & l2) {
+    return key(l1) < key(l2);
+  });
+  alphabet_.erase(std::unique(begin(alphabet_),
+                              end(alphabet_),
+                              [&](auto & l1, auto & l2) {
+                                return key(l1) == key(l2);
+                              }),
+                  end(alphabet_));
+}
+
+void
+GraphEnumerator::init_block_relabelings() {
+  auto index_of = [this](Label const & label) {
+    for (int i = 0, sz = alphabet_.size(); i < sz; ++i) {
+      auto const & l = alphabet_[i];
+      if (l.color == label.color && l.block == label.block &&
+          l.role == label.role) {
+        return i;
+      }
+    }
+    throw std::logic_error("GraphEnumerator: relabeled block not in alphabet");
+  };
+
+  bool any_dynamic =
+      std::any_of(begin(alphabet_), end(alphabet_), [](Label const & l) {
+        return has_dynamic_block_colors(l.color);
+      });
+
+  std::vector<int> block_perm(config_.num_blocks);
+  std::iota(begin(block_perm), end(block_perm), 1);
+  do {
+    std::vector<int> relabeling;
+    for (Label label : alphabet_) {
+      if (has_dynamic_block_colors(label.color)) {
+        label.block = block::FinalBlock(block_perm[+label.block - 1]);
+      }
+      relabeling.push_back(index_of(label));
+    }
+    block_relabelings_.push_back(std::move(relabeling));
+  } while (any_dynamic && std::next_permutation(begin(block_perm),
+                                                end(block_perm)));
+}
+
+// Tries every block relabeling, and every ordering of the vertices that keeps
+// them sorted by label, keeping the smallest resulting encoding. Vertices
+// that end up last in some smallest encoding form one orbit under the
+// automorphisms of the graph.
+GraphEnumerator::Canonical
+GraphEnumerator::canonicalize(SmallGraph const & graph) const {
+  int const n = graph.size;
+
+  Canonical best;
+  bool      found = false;
+
+  std::array<int, MaxVertices> labels;
+  std::array<int, MaxVertices> order;
+  std::vector<std::pair<int, int>> ranges;
+
+  for (auto const & relabeling : block_relabelings_) {
+    for (int i = 0; i < n; ++i) {
+      labels[i] = relabeling[graph.labels[i]];
+    }
+    std::iota(begin(order), begin(order) + n, 0);
+    std::stable_sort(begin(order), begin(order) + n, [&](int a, int b) {
+      return labels[a] < labels[b];
+    });
+
+    ranges.clear();
+    for (int from = 0, to = 1; to <= n; ++to) {
+      if (to == n || labels[order[to]] != labels[order[from]]) {
+        if (to - from > 1) {
+          ranges.push_back({from, to});
+        }
+        from = to;
+      }
+    }
+
+    while (true) {
+      CanonicalForm form;
+      for (int k = 0; k < n; ++k) {
+        form.labels[k] = labels[order[k]];
+        for (int m = 0; m < n; ++m) {
+          if (graph.out_edges[order[k]] & bit(order[m])) {
+            form.edges |= std::uint64_t(1) << (k * n + m);
+          }
+        }
+      }
+
+      if (not found || form < best.form) {
+        found           = true;
+        best.form       = form;
+        best.last_orbit = bit(order[n - 1]);
+
+        best.graph      = SmallGraph{};
+        best.graph.size = n;
+        for (int k = 0; k < n; ++k) {
+          best.graph.labels[k] = form.labels[k];
+          for (int m = 0; m < n; ++m) {
+            if (graph.out_edges[order[k]] & bit(order[m])) {
+              best.graph.out_edges[k] |= bit(m);
+            }
+          }
+        }
+      }
+      else if (form == best.form) {
+        best.last_orbit |= bit(order[n - 1]);
+      }
+
+      auto range_iter = ranges.begin();
+      while (range_iter != ranges.end() &&
+             not std::next_permutation(begin(order) + range_iter->first,
+                                       begin(order) + range_iter->second)) {
+        ++range_iter;
+      }
+      if (range_iter == ranges.end()) {
+        break;
+      }
+    }
+  }
+  return best;
+}
+
+// Only checks edges between the new vertex and the existing ones; acyclicity
+// is checked by the caller.
+bool
+GraphEnumerator::can_attach(SmallGraph const & graph, int label,
+                            std::uint8_t parents, std::uint8_t children) const {
+  auto const new_color = alphabet_[label].color;
+  if (is_nothing(new_color) && children != 0) {
+    return false;
+  }
+  for (int i = 0; i < graph.size; ++i) {
+    auto const color = alphabet_[graph.labels[i]].color;
+    if (parents & bit(i)) {
+      if (is_nothing(color) || (not has_from(color) && has_from(new_color))) {
+        return false;
+      }
+    }
+    if (children & bit(i)) {
+      if (not has_from(new_color) && has_from(color)) {
+        return false;
+      }
+    }
+  }
+  return true;
+}
+
+bool
+GraphEnumerator::is_complete_rule_graph(SmallGraph const & graph) const {
+  std::array<int, MaxVertices> indegree{};
+  for (int i = 0; i < graph.size; ++i) {
+    for (int j = 0; j < graph.size; ++j) {
+      indegree[j] += (graph.out_edges[i] & bit(j)) != 0;
+    }
+  }
+
+  for (int i = 0; i < graph.size; ++i) {
+    auto const & label = alphabet_[graph.labels[i]];
+    if (has_from(label.color)) {
+      if (graph.out_edges[i] == 0) {
+        return false; // pattern that goes nowhere
+      }
+      if (indegree[i] == 0 && label.role != vertex::VertexRole::START) {
+        return false; // unreachable
+      }
+    }
+    else if (indegree[i] == 0) {
+      return false; // replacement without a pattern
+    }
+  }
+  return true;
+}
+
+Graph
+GraphEnumerator::to_graph(SmallGraph const & graph) const {
+  Vertices                vertices;
+  matrix::AdjacencyMatrix adjacency_matrix(graph.size);
+  for (int i = 0; i < graph.size; ++i) {
+    auto const & label = alphabet_[graph.labels[i]];
+    vertices.add_vertex_single(
+        std::to_string(i), label.block, label.color, label.role);
+    for (int j = 0; j < graph.size; ++j) {
+      if (graph.out_edges[i] & bit(j)) {
+        adjacency_matrix.add_edge(i, j);
+      }
+    }
+  }
+  return Graph(std::move(vertices),
+               std::move(adjacency_matrix),
+               "enumerated-" + std::to_string(num_emitted_));
+}
+
+void
+GraphEnumerator::extend(SmallGraph const &    graph,
+                        GraphCallback const & callback) {
+  if (graph.size > 0 &&
+      (not config_.complete_rules_only || is_complete_rule_graph(graph))) {
+    callback(to_graph(graph));
+    ++num_emitted_;
+  }
+
+  int const n = graph.size;
+  if (n == config_.max_vertices) {
+    return;
+  }
+
+  // reachable[i] has a bit for each vertex reachable from i (including i)
+  std::array<std::uint8_t, MaxVertices> reachable{};
+  for (int i = 0; i < n; ++i) {
+    reachable[i] = bit(i) | graph.out_edges[i];
+  }
+  for (int pass = 0; pass < n; ++pass) {
+    for (int i = 0; i < n; ++i) {
+      for (int j = 0; j < n; ++j) {
+        if (reachable[i] & bit(j)) {
+          reachable[i] |= reachable[j];
+        }
+      }
+    }
+  }
+
+  // The canonically-last vertex always has the greatest color and start bit,
+  // since block relabeling cannot change those.
+  auto class_of = [this](int label) {
+    return std::pair<int, int>(+alphabet_[label].color,
+                               +alphabet_[label].role);
+  };
+  std::pair<int, int> max_class{-1, -1};
+  for (int i = 0; i < n; ++i) {
+    max_class = std::max(max_class, class_of(graph.labels[i]));
+  }
+
+  // Equivalent augmentations of this parent give isomorphic children; they
+  // are only filtered among siblings, never across parents.
+  std::set<CanonicalForm> siblings;
+
+  int const subsets = 1 << n;
+  for (int label = 0, sz = alphabet_.size(); label < sz; ++label) {
+    if (class_of(label) < max_class) {
+      continue;
+    }
+    for (int parents = 0; parents < subsets; ++parents) {
+      for (int children = 0; children < subsets; ++children) {
+        if ((parents & children) ||
+            not can_attach(graph, label, parents, children)) {
+          continue;
+        }
+        bool cycle = false;
+        for (int c = 0; c < n && not cycle; ++c) {
+          cycle = (children & bit(c)) && (reachable[c] & parents);
+        }
+        if (cycle) {
+          continue;
+        }
+
+        SmallGraph child   = graph;
+        child.size         = n + 1;
+        child.labels[n]    = label;
+        child.out_edges[n] = children;
+        for (int p = 0; p < n; ++p) {
+          if (parents & bit(p)) {
+            child.out_edges[p] |= bit(n);
+          }
+        }
+
+        Canonical canonical = canonicalize(child);
+        if ((canonical.last_orbit & bit(n)) &&
+            siblings.insert(canonical.form).second) {
+          extend(canonical.graph, callback);
+        }
+      }
+    }
+  }
+}
+
+int
+GraphEnumerator::enumerate(GraphCallback const & callback) {
+  num_emitted_ = 0;
+  extend(SmallGraph{}, callback);
+  return num_emitted_;
+}
@@ -0,0 +1,105 @@
+#pragma once
+
+#include "Block.hpp"
+#include "Color.hpp"
+#include "Graph.hpp"
+
+#include <array>
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+// Generates every non-isomorphic rule graph up to a number of vertices, using
+// canonical augmentation (McKay's "orderly" generation): graphs grow one
+// vertex at a time, and a child is only kept if its new vertex is the one
+// that canonical labeling would remove, so each isomorphism class is reached
+// through exactly one parent. Nothing is remembered between parents, so
+// memory stays proportional to the search depth, not to the output.
+//
+// Vertices hold a single block (as GraphCreator makes them, before
+// compress_vertices). Isomorphism is the same as in Graph::check_isomorphism:
+// vertices may be reordered, and blocks of colors with dynamic blocks may be
+// consistently relabeled.
+//
+// Graph construction only adds properties kept by removing vertices (acyclic,
+// no edges from TO to FROM vertices, NOTHING vertices have no children), so
+// every class is reachable. Properties of complete rules (FROM patterns lead
+// to a TO, unreachable FROM vertices are starts, every TO has a parent) do
+// not survive removal, so they are only checked when emitting.
+
+struct EnumerationConfig {
+  // graphs with 1 through max_vertices vertices are generated
+  int max_vertices = 3;
+
+  // colors available to vertices. Start bits are tried on every FROM color.
+  std::vector<color::FinalColor> colors;
+
+  // blocks 1..num_blocks are tried for colors whose blocks vary. Colors with
+  // only one block value (NOTHING, WILDCARD) always use block 1.
+  int num_blocks = 1;
+
+  // when false, every acyclic graph over the alphabet is emitted, whether or
+  // not it could come from a level's rules.
+  bool complete_rules_only = true;
+};
+
+class GraphEnumerator {
+public:
+  // more vertices would not fit the 64-bit adjacency codes used to compare
+  // canonical forms.
+  static constexpr int MaxVertices = 8;
+
+  using GraphCallback = std::function<void(Graph &&)>;
+
+  explicit GraphEnumerator(EnumerationConfig const & config);
+
+  // calls callback once per isomorphism class, returns the number emitted
+  int enumerate(GraphCallback const & callback);
+
+private:
+  struct Label {
+    color::FinalColor  color;
+    block::FinalBlock  block;
+    vertex::VertexRole role;
+  };
+
+  // A graph under construction. Labels are indices into alphabet_, and
+  // out_edges_[i] has bit j set for an edge i->j.
+  struct SmallGraph {
+    int                                   size = 0;
+    std::array<int, MaxVertices>          labels{};
+    std::array<std::uint8_t, MaxVertices> out_edges{};
+  };
+
+  struct CanonicalForm {
+    std::array<int, MaxVertices> labels{};
+    std::uint64_t                edges = 0;
+
+    auto operator<=>(CanonicalForm const &) const = default;
+  };
+
+  struct Canonical {
+    CanonicalForm form;
+    SmallGraph    graph;      // the input relabeled into canonical order
+    std::uint8_t  last_orbit; // vertices some canonical labeling puts last
+  };
+
+  void      init_alphabet();
+  void      init_block_relabelings();
+  Canonical canonicalize(SmallGraph const & graph) const;
+  void      extend(SmallGraph const & graph, GraphCallback const & callback);
+  bool      can_attach(SmallGraph const & graph, int label,
+                       std::uint8_t parents, std::uint8_t children) const;
+  bool      is_complete_rule_graph(SmallGraph const & graph) const;
+  Graph     to_graph(SmallGraph const & graph) const;
+
+private:
+  EnumerationConfig  config_;
+  std::vector<Label> alphabet_;
+
+  // for each consistent relabeling of dynamic blocks, the label each label
+  // becomes. The first is the identity.
+  std::vector<std::vector<int>> block_relabelings_;
+
+  int num_emitted_ = 0;
+};
@@ -1,60 +1,115 @@
 #include "GraphLoader.hpp"
 #include "GraphCreator.hpp"
-#include <filesystem>
+#include "MappedFile.hpp"
+#include <algorithm>
+#include <atomic>
+#include <exception>
+#include <optional>
+#include <thread>
 #include <boost/json.hpp>
 
 namespace p1 {
 using namespace boost;
 
-auto
-read(std::string const & filename) {
-  std::string res;
-  res.resize(std::filesystem::file_size(filename));
-  auto f = fopen(filename.c_str(), "rb");
-  if (f) {
-    std::fread(res.data(), 1, res.size(), f);
-  }
-  fclose(f);
-  return res;
+// Every node and string of the DOM comes from storage, so that a caller
+// with an arena can free the whole thing at once.
+json::value
+read_file_json(std::string const & filename, json::storage_ptr storage) {
+  MappedFile file(filename);
+  return json::parse(file.contents(), std::move(storage));
 }
 
-json::value
-read_file_json(std::string const & filename) {
-  return json::parse(read(filename));
+// Builds the graph of each level, with levels handed out to num_threads
+// workers one at a time, in level order, as they finish. Graphs are appended
+// to graphs in level order up to the first level that failed, whose exception
+// is returned; which level that is doesn't depend on the threads' timing, as
+// every level before it still gets built.
+static std::exception_ptr
+build_graphs(json::array const & levels_ary, int num_threads,
+             std::vector<Graph> & graphs) {
+  std::size_t const                 num_levels = levels_ary.size();
+  std::vector<std::optional<Graph>> built(num_levels);
+  std::vector<std::exception_ptr>   errors(num_levels);
+  std::atomic<std::size_t>          next_level{0};
+  std::atomic<std::size_t>          first_failed{num_levels};
+
+  auto worker = [&] {
+    for (;;) {
+      std::size_t idx = next_level++;
+      if (idx >= first_failed) {
+        break;
+      }
+      try {
+        built[idx] = GraphCreator(levels_ary[idx].as_object())
+                         .compress_vertices()
+                         .group_by_colors()
+                         .create();
+      }
+      catch (...) {
+        errors[idx] = std::current_exception();
+        // only levels before this one are still worth building
+        for (std::size_t cur = first_failed;
+             idx < cur && not first_failed.compare_exchange_weak(cur, idx);) {
+        }
+      }
+    }
+  };
+
+  num_threads = std::clamp<int>(num_threads, 1, std::max<int>(num_levels, 1));
+  {
+    std::vector<std::jthread> workers;
+    for (int i = 1; i < num_threads; ++i) {
+      workers.emplace_back(worker);
+    }
+    worker();
+  }
+
+  std::size_t const num_built = first_failed;
+  graphs.reserve(num_built);
+  for (std::size_t idx = 0; idx < num_built; ++idx) {
+    graphs.push_back(std::move(*built[idx]));
+  }
+  return num_built < num_levels ? errors[num_built] : nullptr;
 }
 
 std::vector<Graph>
-create_graphs(json::value const & file_json) {
-  auto levels_ary = file_json.at("levels").as_array();
-
+create_graphs_from_json(json::value const & file_json, int num_threads) {
+  if (num_threads == AllThreads) {
+    num_threads = std::thread::hardware_concurrency();
+  }
   std::vector<Graph> graphs;
-  graphs.reserve(levels_ary.size());
-  int outer_count = 0;
-  for (auto const & level_val : levels_ary) {
-    Graph cur_graph = GraphCreator(level_val.as_object())
-                          .compress_vertices()
-                          .group_by_colors()
-                          .create();
+  std::exception_ptr error =
+      build_graphs(file_json.at("levels").as_array(), num_threads, graphs);
+
+  // Levels are independent until here, where each is compared with all those
+  // before it. A level that failed to build ends the output, after the levels
+  // before it, as it would if they were built one by one.
+  for (int outer_count = 0, sz = graphs.size(); outer_count < sz;
+       ++outer_count) {
+    Graph const & cur_graph = graphs[outer_count];
     std::cout << "creating: " << cur_graph.level_name() << std::endl;
-    int inner_count = 0;
-    for (Graph const & graph : graphs) {
+    for (int inner_count = 0; inner_count < outer_count; ++inner_count) {
+      Graph const & graph = graphs[inner_count];
       if (cur_graph.check_isomorphism(graph)) {
         std::cout << "Warning: Levels are isomorphisms: " << graph.level_name()
                   << "(" << inner_count << ") and " << cur_graph.level_name()
                   << "(" << outer_count << ")\n";
       }
-      ++inner_count;
     }
-    graphs.push_back(std::move(cur_graph));
-    ++outer_count;
+  }
+  if (error) {
+    std::rethrow_exception(error);
   }
   return graphs;
 }
 
 std::vector<Graph>
-create_graphs(std::string const & filename) {
-  auto file_json = read_file_json(filename);
-  return create_graphs(file_json);
+create_graphs(std::string const & filename, int num_threads) {
+  // The DOM is only read, and only until the graphs are built, so it goes in
+  // an arena that grows a block at a time and is dropped in one go.
+  json::monotonic_resource arena;
+  auto file_json = read_file_json(filename, &arena);
+  return create_graphs_from_json(file_json, num_threads);
 }
 
 } // namespace p1
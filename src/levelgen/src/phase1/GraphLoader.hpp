@@ -2,9 +2,24 @@
 
 #include "Graph.hpp"
 
+#include <boost/json.hpp>
 #include <string>
 #include <vector>
 
 namespace p1 {
-std::vector<Graph> create_graphs(std::string const & filename);
+
+// num_threads for one per hardware thread
+constexpr int AllThreads = 0;
+
+// filename may be "-" for standard input (see MappedFile).
+// Levels are built into graphs on num_threads threads, then checked against
+// each other for isomorphisms in file order. The graphs come back in level
+// order whatever the thread count.
+std::vector<Graph> create_graphs(std::string const & filename,
+                                 int                 num_threads = AllThreads);
+
+// from an already parsed file: an object with a "levels" array
+std::vector<Graph>
+create_graphs_from_json(boost::json::value const & file_json,
+                        int                        num_threads = AllThreads);
 }
@@ -0,0 +1,134 @@
+#include "GraphPack.hpp"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+#include <utility>
+
+namespace p1 {
+
+static_assert(sizeof(GraphPackView::Header) % sizeof(GraphPackView::Word) ==
+              0);
+static_assert(sizeof(GraphPackView::Entry) % sizeof(GraphPackView::Word) ==
+              0);
+
+// the words of the header and index of a pack of num_graphs graphs
+static std::size_t
+front_words(std::size_t num_graphs) {
+  return (sizeof(GraphPackView::Header) +
+          num_graphs * sizeof(GraphPackView::Entry)) /
+         sizeof(GraphPackView::Word);
+}
+
+GraphPackView::GraphPackView(WordSpan words) : words_(words) {
+  if (words.size() < HeaderWords) {
+    throw std::runtime_error("Graph pack too short for its header");
+  }
+  auto const & hdr = header();
+  if (hdr.magic != Magic || hdr.version != Version) {
+    throw std::runtime_error("Not a graph pack, or another version");
+  }
+  if (hdr.num_words != words.size() ||
+      HeaderWords + hdr.num_graphs * EntryWords > words.size()) {
+    throw std::runtime_error("Graph pack is truncated");
+  }
+  for (int i = 0; i < size(); ++i) {
+    if (entries()[i].offset >= words.size()) {
+      throw std::runtime_error("Graph pack index is corrupt");
+    }
+  }
+}
+
+GraphPackView::WordSpan
+GraphPack::words_of(MappedFile const & file, std::vector<Word> & copy) {
+  auto const content = file.contents();
+  if (content.size() % sizeof(Word) != 0) {
+    throw std::runtime_error("Graph pack is not a whole number of words");
+  }
+  std::size_t const num_words = content.size() / sizeof(Word);
+  if (reinterpret_cast<std::uintptr_t>(content.data()) % alignof(Word) != 0) {
+    // read rather than mapped, into a buffer that isn't aligned for words
+    copy.resize(num_words);
+    std::memcpy(copy.data(), content.data(), content.size());
+    return copy;
+  }
+  return {reinterpret_cast<Word const *>(content.data()), num_words};
+}
+
+GraphPack::GraphPack(std::string const & filename)
+    : file_(filename), view_(words_of(file_, aligned_copy_)) {
+}
+
+// Freezes the graphs one at a time, handing each one's words to write as
+// soon as it's frozen, so only one is ever held. Returns the header and
+// index to go in front of them, which can only be filled in after.
+template <typename WriteT>
+static std::pair<GraphPackView::Header, std::vector<GraphPackView::Entry>>
+freeze_each(std::span<Graph const> graphs, WriteT write) {
+  using Header = GraphPackView::Header;
+  using Entry  = GraphPackView::Entry;
+
+  std::vector<Entry> entries(graphs.size());
+  std::uint64_t      offset = front_words(graphs.size());
+  for (std::size_t i = 0; i < graphs.size(); ++i) {
+    FrozenGraph frozen(graphs[i]);
+    entries[i] = {offset, graphs[i].fingerprint()};
+    offset += frozen.words().size();
+    write(frozen.words());
+  }
+
+  Header hdr{};
+  hdr.magic      = GraphPackView::Magic;
+  hdr.version    = GraphPackView::Version;
+  hdr.num_graphs = graphs.size();
+  hdr.num_words  = offset;
+  return {hdr, std::move(entries)};
+}
+
+std::vector<GraphPackView::Word>
+pack_graphs(std::span<Graph const> graphs) {
+  using Word = GraphPackView::Word;
+
+  std::vector<Word> words(front_words(graphs.size()));
+  auto [hdr, entries] = freeze_each(graphs, [&](GraphPackView::WordSpan w) {
+    words.insert(words.end(), w.begin(), w.end());
+  });
+
+  std::memcpy(words.data(), &hdr, sizeof(hdr));
+  if (not entries.empty()) {
+    std::memcpy(words.data() + sizeof(hdr) / sizeof(Word), entries.data(),
+                entries.size() * sizeof(entries[0]));
+  }
+  return words;
+}
+
+// The graphs go straight to the file as they are frozen, after room for the
+// header and index, which are written last.
+void
+write_graph_pack(std::string const &    filename,
+                 std::span<Graph const> graphs) {
+  using Word = GraphPackView::Word;
+
+  std::ofstream out(filename, std::ios::binary | std::ios::trunc);
+
+  auto write_bytes = [&](void const * data, std::size_t size) {
+    out.write(static_cast<char const *>(data), size);
+  };
+
+  std::vector<Word> const room(front_words(graphs.size()));
+  write_bytes(room.data(), room.size() * sizeof(Word));
+  auto [hdr, entries] = freeze_each(graphs, [&](GraphPackView::WordSpan w) {
+    write_bytes(w.data(), w.size_bytes());
+  });
+
+  out.seekp(0);
+  write_bytes(&hdr, sizeof(hdr));
+  write_bytes(entries.data(), entries.size() * sizeof(entries[0]));
+  if (not out.flush()) {
+    throw std::runtime_error("Could not write graph pack: " + filename);
+  }
+}
+
+} // namespace p1
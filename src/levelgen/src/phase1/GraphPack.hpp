@@ -0,0 +1,133 @@
+#pragma once
+
+#include "Fingerprint.hpp"
+#include "FrozenGraph.hpp"
+#include "Graph.hpp"
+#include "MappedFile.hpp"
+
+#include <cstdint>
+#include <span>
+#include <string>
+#include <vector>
+
+// A graph pack (.lgp) is a corpus of finished graphs, written once (see
+// "levelgen compile") and mapped back in by each analysis that reads it, so
+// that no json is parsed and no graph rebuilt. The file is 64-bit words:
+//
+//   header | index: (offset, fingerprint) per graph | frozen graphs
+//
+// each graph being a FrozenGraph buffer, name included, and offsets counting
+// words from the start of the file. A pack is only read by a build with the
+// same word order and vertex layout as the one that wrote it.
+
+namespace p1 {
+
+class GraphPackView {
+public:
+  using Word     = FrozenGraphView::Word;
+  using WordSpan = FrozenGraphView::WordSpan;
+
+  static constexpr std::uint32_t Magic   = 0x4b50474c; // "LGPK"
+  static constexpr std::uint16_t Version = 1;
+
+  struct Header {
+    std::uint32_t magic;
+    std::uint16_t version;
+    std::uint16_t reserved;
+    std::uint32_t num_graphs;
+    std::uint32_t reserved2;
+    std::uint64_t num_words; // the whole pack, header included
+  };
+
+  struct Entry {
+    std::uint64_t     offset;
+    fingerprint::Hash fingerprint;
+  };
+
+  // Throws std::runtime_error if words isn't a pack this build wrote, or any
+  // graph starts outside it. Each graph's own header is checked when it's
+  // looked at.
+  explicit GraphPackView(WordSpan words);
+
+  int
+  size() const {
+    return header().num_graphs;
+  }
+
+  // the graph itself, read in place
+  FrozenGraphView
+  operator[](int idx) const {
+    return FrozenGraphView(words_.subspan(entries()[idx].offset));
+  }
+
+  // the graph's Graph::fingerprint(), stored so as not to be recomputed
+  fingerprint::Hash
+  fingerprint(int idx) const {
+    return entries()[idx].fingerprint;
+  }
+
+  WordSpan
+  words() const {
+    return words_;
+  }
+
+private:
+  static constexpr std::size_t HeaderWords = sizeof(Header) / sizeof(Word);
+  static constexpr std::size_t EntryWords  = sizeof(Entry) / sizeof(Word);
+
+  Header const &
+  header() const {
+    return *reinterpret_cast<Header const *>(words_.data());
+  }
+
+  Entry const *
+  entries() const {
+    return reinterpret_cast<Entry const *>(words_.data() + HeaderWords);
+  }
+
+  WordSpan words_;
+};
+
+// A pack file, mapped (see MappedFile) rather than read; the views it hands
+// out point into the mapping, so are only good while it lives. A file that
+// had to be read into a buffer not aligned for words is copied into one that
+// is.
+class GraphPack {
+public:
+  explicit GraphPack(std::string const & filename);
+
+  int
+  size() const {
+    return view_.size();
+  }
+
+  FrozenGraphView
+  operator[](int idx) const {
+    return view_[idx];
+  }
+
+  fingerprint::Hash
+  fingerprint(int idx) const {
+    return view_.fingerprint(idx);
+  }
+
+private:
+  using Word = GraphPackView::Word;
+
+  static GraphPackView::WordSpan words_of(MappedFile const & file,
+                                          std::vector<Word> & copy);
+
+  MappedFile        file_;
+  std::vector<Word> aligned_copy_; // only if the file's contents weren't
+  GraphPackView     view_;
+};
+
+// the words of a pack of graphs, in order
+std::vector<GraphPackView::Word> pack_graphs(std::span<Graph const> graphs);
+
+// The same words, written as each graph is frozen, so only one frozen graph
+// is held at a time. Throws std::runtime_error if filename can't be written.
+void write_graph_pack(std::string const &    filename,
+                      std::span<Graph const> graphs);
+
+} // namespace p1
@@ -0,0 +1,287 @@
+#pragma once
+
+#include "Block.hpp"
+#include "Color.hpp"
+#include "Vertex.hpp"
+#include "VertexBatch.hpp"
+#include "debug.hpp"
+
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <iterator>
+#include <numeric>
+#include <ranges>
+
+// The isomorphism search behind Graph::check_isomorphism, written against
+// any graph type that provides:
+//
+//   int                       size() const;
+//   vertex::Vertex            vertex_at(int idx) const;
+//   span of vertex::Vertex    packed_vertices() const;  every vertex_at
+//   span of vertex::Vertex    continuation_of(int idx) const;
+//   bool                      has_edge(int from, int to) const;
+//   range of (begin, end)     permutable_block_ranges() const;
+//   range of shape keys       shape_keys() const;
+//
+// so Graph and FrozenGraph (and a mix of the two) compare the same way.
+// Vertices outside the permutable ranges must match position for position.
+// Within a range of same-color vertices every ordering is tried, and blocks
+// of colors with dynamic blocks may be consistently relabeled.
+
+namespace isomorphism {
+
+using BlockEquivalenceMap = block::FinalBlock[16];
+
+inline bool
+is_valid_mapping(BlockEquivalenceMap & map, block::FinalBlock b1,
+                 block::FinalBlock b2) {
+  if (map[+b1] == block::Unused) {
+    map[+b1] = b2;
+  }
+  return map[+b1] == b2;
+}
+
+inline bool
+check_blocks(BlockEquivalenceMap & blockmap, vertex::Vertex v1,
+             vertex::Vertex v2) {
+  assert(get_final_color(v1) == get_final_color(v2));
+
+  auto const sz1 = size(v1);
+  if (sz1 != size(v2)) {
+    DEBUGTRACE;
+    return false;
+  }
+
+  if (get_start_bit(v1) != get_start_bit(v2)) {
+    DEBUGTRACE;
+    return false;
+  }
+
+  if (has_dynamic_block_colors(get_final_color(v1))) {
+    for (int i = 0; i < sz1; ++i) {
+      if (not is_valid_mapping(blockmap, get_block(v1, i), get_block(v2, i))) {
+        DEBUGTRACE;
+        return false;
+      }
+    }
+  }
+  else {
+    for (int i = 0; i < sz1; ++i) {
+      if (get_block(v1, i) != get_block(v2, i)) {
+        DEBUGTRACE;
+        return false;
+      }
+    }
+  }
+  return true;
+}
+
+// check_blocks over a vertex and then each of its continuation records, which
+// must pair up one to one.
+template <typename Graph1T, typename Graph2T>
+bool
+check_run(BlockEquivalenceMap & blockmap, Graph1T const & graph1, int idx1,
+          Graph2T const & graph2, int idx2) {
+  if (not check_blocks(blockmap, graph1.vertex_at(idx1),
+                       graph2.vertex_at(idx2))) {
+    return false;
+  }
+
+  auto const run1 = graph1.continuation_of(idx1);
+  auto const run2 = graph2.continuation_of(idx2);
+  if (run1.size() != run2.size()) {
+    DEBUGTRACE;
+    return false;
+  }
+  for (std::size_t i = 0; i < run1.size(); ++i) {
+    if (not check_blocks(blockmap, run1[i], run2[i])) {
+      return false;
+    }
+  }
+  return true;
+}
+
+// Calls back with each (begin, end) run of indices outside the permutable
+// block ranges of graph, which (being outside them) are the same vertex
+// positions in every graph.
+template <typename CallbackT, typename GraphT>
+void
+visit_fixed_segments(CallbackT cb, GraphT const & graph) {
+  int idx = 0;
+  for (auto [begin_idx, end_idx] : graph.permutable_block_ranges()) {
+    if (idx != begin_idx) {
+      cb(idx, int(begin_idx));
+    }
+    // jump to start of next nonpermutable range
+    idx = end_idx;
+  }
+  // Visit the rest...
+  if (idx != graph.size()) {
+    cb(idx, graph.size());
+  }
+}
+
+// Calls back with each index of visit_fixed_segments
+template <typename CallbackT, typename GraphT>
+void
+visit_fixed_indices(CallbackT cb, GraphT const & graph) {
+  visit_fixed_segments(
+      [&cb](int idx, int end_idx) {
+        for (; idx != end_idx; ++idx) {
+          cb(idx);
+        }
+      },
+      graph);
+}
+
+template <typename Graph1T, typename Graph2T>
+bool
+check_basic_colorgroup_compatibility(Graph1T const & graph1,
+                                     Graph2T const & graph2,
+                                     BlockEquivalenceMap & colormap) {
+  if (graph1.size() != graph2.size()) {
+    DEBUGTRACE;
+    return false;
+  }
+  auto const vertices1 = graph1.packed_vertices();
+  auto const vertices2 = graph2.packed_vertices();
+  if (not vertex::batch::same_colors(vertices1, vertices2)) {
+    DEBUGTRACE;
+    return false;
+  }
+
+  // check_blocks' start bit and size tests, a whole segment of fixed
+  // vertices at a time, before pairing them up one by one
+  bool valid = true;
+  visit_fixed_segments(
+      [&](int idx, int end_idx) {
+        valid = valid && vertex::batch::same_shapes(
+                             vertices1.subspan(idx, end_idx - idx),
+                             vertices2.subspan(idx, end_idx - idx));
+      },
+      graph1);
+  if (not valid) {
+    DEBUGTRACE;
+    return false;
+  }
+
+  visit_fixed_indices(
+      [&](int idx) {
+        valid &= check_run(colormap, graph1, idx, graph2, idx);
+        DEBUGTRACE;
+      },
+      graph1);
+
+  return valid;
+}
+
+template <typename Graph1T, typename Graph2T>
+bool
+check_static_vertex_equivalence(BlockEquivalenceMap & colormap,
+                                Graph1T const & graph1,
+                                Graph2T const & graph2) {
+  // static vertices are in the same logical index as their physical index, and
+  // remain there (so no mapping necessary)
+  bool nonpermutable_equivalence = true;
+  visit_fixed_indices(
+      [&](int idx) {
+        nonpermutable_equivalence &=
+            check_run(colormap, graph1, idx, graph2, idx);
+      },
+      graph1);
+  return nonpermutable_equivalence;
+}
+
+// corresponding vertices (as mapped via indices) have equal block counts,
+// contain equivalent blocks via colormap
+// These are "dynamic" because their logical numbers change as we search,
+// reordering vertices within the same color group
+template <typename Graph1T, typename Graph2T, typename IndexVecT>
+bool
+check_dynamic_vertex_equivalence(BlockEquivalenceMap & colormap,
+                                 Graph1T const & graph1, Graph2T const & graph2,
+                                 IndexVecT const & indices) {
+  for (auto [from, to] : graph1.permutable_block_ranges()) {
+    for (; from != to; ++from) {
+      if (not check_run(colormap, graph1, indices[from], graph2, from)) {
+        DEBUGTRACE;
+        return false;
+      }
+    }
+  }
+  return true;
+}
+
+template <typename Graph1T, typename Graph2T, typename IndexVecT>
+bool
+equivalent_adjacency_matrices(Graph1T const & graph1, Graph2T const & graph2,
+                              IndexVecT const & indices) {
+  int const sz = graph1.size();
+  assert(sz == graph2.size());
+  assert(std::ssize(indices) == sz);
+
+  for (int i = 0; i < sz; ++i) {
+    for (int j = 0; j < sz; ++j) {
+      if (graph1.has_edge(indices[i], indices[j]) != graph2.has_edge(i, j)) {
+        DEBUGTRACE;
+        return false;
+      }
+    }
+  }
+  return true;
+}
+
+// indices is scratch space of graph1.size() ints, so a caller that compares
+// often can keep one around rather than allocate it every call.
+template <typename Graph1T, typename Graph2T, typename IndexVecT>
+bool
+check(Graph1T const & graph1, Graph2T const & graph2, IndexVecT & indices) {
+  // every vertex pairing checked below needs equal color, start bit and size
+  if (not std::ranges::equal(graph1.shape_keys(), graph2.shape_keys())) {
+    DEBUGTRACE;
+    return false;
+  }
+
+  std::iota(begin(indices), end(indices), 0);
+  BlockEquivalenceMap colormap{};
+
+  if (not check_basic_colorgroup_compatibility(graph1, graph2, colormap)) {
+    DEBUGTRACE;
+    return false;
+  }
+
+  auto const & ranges = graph1.permutable_block_ranges();
+  if (std::ranges::empty(ranges)) {
+    DEBUGTRACE;
+    return check_static_vertex_equivalence(colormap, graph1, graph2) &&
+           equivalent_adjacency_matrices(graph1, graph2, indices);
+  }
+
+  // Permute every ordering of each permutable block range, and check for
+  // equivalence
+  auto range_idx_iter = std::ranges::begin(ranges),
+       range_idx_end  = std::ranges::end(ranges);
+
+  while (true) {
+    BlockEquivalenceMap dynamic_colormap;
+    std::copy(std::begin(colormap), std::end(colormap), dynamic_colormap);
+    if (check_dynamic_vertex_equivalence(
+            dynamic_colormap, graph1, graph2, indices) &&
+        check_static_vertex_equivalence(dynamic_colormap, graph1, graph2) &&
+        equivalent_adjacency_matrices(graph1, graph2, indices)) {
+      return true;
+    }
+    range_idx_iter     = std::ranges::begin(ranges);
+    auto base_idx_iter = begin(indices);
+    while (not std::next_permutation(base_idx_iter + range_idx_iter->first,
+                                     base_idx_iter + range_idx_iter->second)) {
+      if (++range_idx_iter == range_idx_end) {
+        DEBUGTRACE;
+        return false;
+      }
+    }
+  }
+}
+
+} // namespace isomorphism
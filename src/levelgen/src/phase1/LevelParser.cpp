@@ -0,0 +1,538 @@
+#include "LevelParser.hpp"
+#include "GraphCreator.hpp"
+#include "MappedFile.hpp"
+#include "RuleSide.hpp"
+
+#include <boost/json.hpp>
+#include <boost/json/basic_parser_impl.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <optional>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+namespace p1 {
+using namespace boost;
+
+namespace {
+
+class LevelHandler {
+public:
+  static constexpr std::size_t max_object_size = std::size_t(-1);
+  static constexpr std::size_t max_array_size  = std::size_t(-1);
+  static constexpr std::size_t max_key_size    = std::size_t(-1);
+  static constexpr std::size_t max_string_size = std::size_t(-1);
+
+  LevelHandler(std::string_view json_text, GraphCallback const & on_graph,
+               std::pmr::memory_resource * resource)
+      : text_(json_text), on_graph_(on_graph), resource_(resource) {
+  }
+
+  int
+  num_levels() const {
+    return num_levels_;
+  }
+
+  bool
+  on_document_begin(json::error_code &) {
+    return true;
+  }
+
+  bool
+  on_document_end(json::error_code &) {
+    if (not found_levels_) {
+      throw std::runtime_error("Level file has no \"levels\" array");
+    }
+    return true;
+  }
+
+  bool
+  on_object_begin(json::error_code &) {
+    open(Within::Object);
+    return true;
+  }
+
+  bool
+  on_object_end(std::size_t size, json::error_code &) {
+    close(Within::Object, size);
+    return true;
+  }
+
+  bool
+  on_array_begin(json::error_code &) {
+    open(Within::Array);
+    return true;
+  }
+
+  bool
+  on_array_end(std::size_t size, json::error_code &) {
+    close(Within::Array, size);
+    return true;
+  }
+
+  bool
+  on_key_part(json::string_view part, std::size_t, json::error_code &) {
+    pieces_.append(part);
+    return true;
+  }
+
+  bool
+  on_key(json::string_view part, std::size_t, json::error_code &) {
+    key(whole(part));
+    return true;
+  }
+
+  bool
+  on_string_part(json::string_view part, std::size_t, json::error_code &) {
+    if (not skipping()) {
+      pieces_.append(part);
+    }
+    return true;
+  }
+
+  bool
+  on_string(json::string_view part, std::size_t, json::error_code &) {
+    if (not skipping()) {
+      string_value(whole(part));
+    }
+    return true;
+  }
+
+  bool
+  on_number_part(json::string_view, json::error_code &) {
+    return true;
+  }
+
+  bool
+  on_int64(std::int64_t number, json::string_view, json::error_code &) {
+    scalar(number);
+    return true;
+  }
+
+  bool
+  on_uint64(std::uint64_t number, json::string_view, json::error_code &) {
+    scalar(number);
+    return true;
+  }
+
+  bool
+  on_double(double number, json::string_view, json::error_code &) {
+    scalar(number);
+    return true;
+  }
+
+  bool
+  on_bool(bool flag, json::error_code &) {
+    scalar(flag);
+    return true;
+  }
+
+  bool
+  on_null(json::error_code &) {
+    scalar(nullptr);
+    return true;
+  }
+
+  bool
+  on_comment_part(json::string_view, json::error_code &) {
+    return true;
+  }
+
+  bool
+  on_comment(json::string_view, json::error_code &) {
+    return true;
+  }
+
+private:
+  enum class Within { Object, Array };
+
+  // where in a level file the parser is
+  enum class Context {
+    File,
+    Levels,
+    Level,
+    Rules,
+    ToChains,
+    TypeOverrides,
+    TypeConfig,
+    Skipped, // anything else, down to its last bracket
+  };
+
+  // the key whose value is next, within a level or the file
+  enum class Field { Other, Levels, Name, Rules, TypeOverrides };
+
+  struct Chain {
+    RuleSide         side;
+    std::string_view text;
+  };
+
+  bool
+  skipping() const {
+    return not stack_.empty() && stack_.back() == Context::Skipped;
+  }
+
+  // A string the parser delivered in pieces is gathered in pieces_, and
+  // is only good until the next string.
+  std::string_view
+  whole(json::string_view last_part) {
+    if (pieces_.empty()) {
+      return last_part;
+    }
+    pieces_.append(last_part);
+    whole_.swap(pieces_);
+    pieces_.clear();
+    return whole_;
+  }
+
+  [[noreturn]] static void
+  fail(char const * what) {
+    throw std::runtime_error(std::string("Level file: ") + what);
+  }
+
+  void
+  open(Within within) {
+    stack_.push_back(child_context(within));
+  }
+
+  Context
+  child_context(Within within) {
+    bool const object = within == Within::Object;
+    if (stack_.empty()) {
+      if (not object) {
+        fail("expected an object");
+      }
+      return Context::File;
+    }
+    switch (stack_.back()) {
+    case Context::File:
+      if (field_ != Field::Levels) {
+        return Context::Skipped;
+      }
+      if (object) {
+        fail("\"levels\" must be an array");
+      }
+      found_levels_ = true;
+      return Context::Levels;
+    case Context::Levels:
+      if (not object) {
+        fail("each level must be an object");
+      }
+      begin_level();
+      return Context::Level;
+    case Context::Level:
+      return level_field_context(object);
+    case Context::Rules:
+      if (object) {
+        fail("each rule's to chains must be an array");
+      }
+      return Context::ToChains;
+    case Context::ToChains:
+      fail("to chains must be strings");
+    case Context::TypeOverrides:
+      if (not object) {
+        fail("each type override must be an object");
+      }
+      type_config_.reset();
+      return Context::TypeConfig;
+    case Context::TypeConfig:
+      return Context::TypeConfig; // a setting that is an object or array
+    case Context::Skipped:
+      break;
+    }
+    return Context::Skipped;
+  }
+
+  Context
+  level_field_context(bool object) {
+    switch (field_) {
+    case Field::Name:
+      fail("\"name\" must be a string");
+    case Field::Rules:
+      if (not object) {
+        fail("\"rules\" must be an object");
+      }
+      if (rules_begun_) {
+        fail("level has more than one \"rules\"");
+      }
+      rules_begun_ = true;
+      creator_->begin_rules();
+      return Context::Rules;
+    case Field::TypeOverrides:
+      if (not object) {
+        fail("\"type_overrides\" must be an object");
+      }
+      return Context::TypeOverrides;
+    default:
+      return Context::Skipped;
+    }
+  }
+
+  void
+  close(Within within, std::size_t size) {
+    auto const closed = stack_.back();
+    stack_.pop_back();
+    switch (closed) {
+    case Context::Level:
+      end_level();
+      break;
+    case Context::TypeConfig:
+      if (within == Within::Object) {
+        type_config_.push_object(size);
+      }
+      else {
+        type_config_.push_array(size);
+      }
+      if (stack_.back() != Context::TypeConfig) {
+        add_type_override();
+      }
+      break;
+    case Context::TypeOverrides:
+      if (replay_needed_) {
+        replay_rules();
+      }
+      break;
+    default:
+      break;
+    }
+  }
+
+  void
+  key(std::string_view name) {
+    switch (stack_.back()) {
+    case Context::File:
+      field_ = name == "levels" ? Field::Levels : Field::Other;
+      break;
+    case Context::Level:
+      field_ = name == "name"             ? Field::Name
+               : name == "rules"          ? Field::Rules
+               : name == "type_overrides" ? Field::TypeOverrides
+                                          : Field::Other;
+      break;
+    case Context::Rules:
+      add_chain(RuleSide::FROM, name);
+      break;
+    case Context::TypeOverrides:
+      override_block_ = name;
+      break;
+    case Context::TypeConfig:
+      type_config_.push_key(name);
+      break;
+    default:
+      break;
+    }
+  }
+
+  // the context a scalar value is in, unless the format wants a container
+  Context
+  scalar_context() {
+    if (stack_.empty()) {
+      fail("expected an object");
+    }
+    switch (stack_.back()) {
+    case Context::Levels:
+      fail("each level must be an object");
+    case Context::Level:
+      if (field_ == Field::Rules || field_ == Field::TypeOverrides) {
+        fail("\"rules\" and \"type_overrides\" must be objects");
+      }
+      break;
+    case Context::Rules:
+      fail("each rule's to chains must be an array");
+    case Context::TypeOverrides:
+      fail("each type override must be an object");
+    default:
+      break;
+    }
+    return stack_.back();
+  }
+
+  void
+  string_value(std::string_view text) {
+    switch (scalar_context()) {
+    case Context::Level:
+      if (field_ == Field::Name) {
+        level_name_ = text;
+      }
+      break;
+    case Context::ToChains:
+      add_chain(RuleSide::TO, text);
+      break;
+    case Context::TypeConfig:
+      type_config_.push_string(text);
+      break;
+    default:
+      break;
+    }
+  }
+
+  template <typename T>
+  void
+  scalar(T setting) {
+    switch (scalar_context()) {
+    case Context::Level:
+      if (field_ == Field::Name) {
+        fail("\"name\" must be a string");
+      }
+      break;
+    case Context::ToChains:
+      fail("to chains must be strings");
+    case Context::TypeConfig:
+      push_setting(setting);
+      break;
+    default:
+      break;
+    }
+  }
+
+  void
+  push_setting(std::int64_t number) {
+    type_config_.push_int64(number);
+  }
+
+  void
+  push_setting(std::uint64_t number) {
+    type_config_.push_uint64(number);
+  }
+
+  void
+  push_setting(double number) {
+    type_config_.push_double(number);
+  }
+
+  void
+  push_setting(bool flag) {
+    type_config_.push_bool(flag);
+  }
+
+  void
+  push_setting(std::nullptr_t) {
+    type_config_.push_null();
+  }
+
+  void
+  begin_level() {
+    creator_.emplace(resource_);
+    level_name_.clear();
+    chains_.clear();
+    copied_chains_.clear();
+    type_overrides_.clear();
+    rules_begun_   = false;
+    replay_needed_ = false;
+  }
+
+  void
+  end_level() {
+    creator_->set_level_name(level_name_);
+    creator_->finish_rules();
+    on_graph_(creator_->compress_vertices().group_by_colors().create());
+    creator_.reset();
+    ++num_levels_;
+  }
+
+  // Chains are kept (as views) in case a type override comes later and they
+  // have to be replayed. Most point into the text, which outlives the level;
+  // one the parser had to put together is copied.
+  void
+  add_chain(RuleSide side, std::string_view text) {
+    auto const * text_end = text_.data() + text_.size();
+    if (text.data() < text_.data() || text.data() + text.size() > text_end) {
+      text = copied_chains_.emplace_back(text);
+    }
+    chains_.push_back({side, text});
+    feed(chains_.back());
+  }
+
+  void
+  feed(Chain const & chain) {
+    if (chain.side == RuleSide::FROM) {
+      creator_->add_from_chain(chain.text);
+    }
+    else {
+      creator_->add_to_chain(chain.text);
+    }
+  }
+
+  void
+  add_type_override() {
+    json::value type_config = type_config_.release();
+    type_overrides_.emplace_back(override_block_,
+                                 std::move(type_config.as_object()));
+    if (rules_begun_) {
+      replay_needed_ = true;
+    }
+    else {
+      creator_->add_type_override(type_overrides_.back().first,
+                                  type_overrides_.back().second);
+    }
+  }
+
+  // The chains so far were colored without these overrides, so start over.
+  void
+  replay_rules() {
+    creator_.emplace(resource_);
+    for (auto const & [block, type_config] : type_overrides_) {
+      creator_->add_type_override(block, type_config);
+    }
+    creator_->begin_rules();
+    for (auto const & chain : chains_) {
+      feed(chain);
+    }
+    replay_needed_ = false;
+  }
+
+  std::string_view            text_;
+  GraphCallback const &       on_graph_;
+  std::pmr::memory_resource * resource_;
+
+  std::vector<Context> stack_;
+  Field                field_        = Field::Other;
+  bool                 found_levels_ = false;
+  int                  num_levels_   = 0;
+  std::string          pieces_;
+  std::string          whole_;
+
+  // the level being read
+  std::optional<GraphCreator>                      creator_;
+  std::string                                      level_name_;
+  std::vector<Chain>                               chains_;
+  std::deque<std::string>                          copied_chains_;
+  std::vector<std::pair<std::string, json::object>> type_overrides_;
+  std::string                                      override_block_;
+  json::value_stack                                type_config_;
+  bool                                             rules_begun_   = false;
+  bool                                             replay_needed_ = false;
+};
+
+} // namespace
+
+int
+parse_graphs(std::string_view json_text, GraphCallback const & on_graph,
+             std::pmr::memory_resource * resource) {
+  json::basic_parser<LevelHandler> parser(
+      json::parse_options(), json_text, on_graph, resource);
+  json::error_code ec;
+  auto const       used =
+      parser.write_some(false, json_text.data(), json_text.size(), ec);
+  // write_some stops after the first document; anything but whitespace after
+  // it is an error, as it is to json::parse
+  if (not ec && used != json_text.size()) {
+    ec = json::error::extra_data;
+  }
+  if (ec) {
+    throw std::runtime_error("Level file: " + ec.message() + " at offset " +
+                             std::to_string(used));
+  }
+  return parser.handler().num_levels();
+}
+
+int
+parse_graphs_in_file(std::string const &   filename,
+                     GraphCallback const & on_graph) {
+  MappedFile file(filename);
+  return parse_graphs(file.contents(), on_graph);
+}
+
+} // namespace p1
@@ -0,0 +1,38 @@
+#pragma once
+
+#include "Graph.hpp"
+#include "LevelStream.hpp"
+
+#include <memory_resource>
+#include <string>
+#include <string_view>
+
+// The fastest way in: a json::basic_parser handler that feeds the name,
+// type_overrides and rules of each level straight into a GraphCreator as the
+// parser reaches them. No json values are built beyond each type override's
+// settings, and chains are passed on as views into the text wherever the
+// parser allows, so nothing is copied. Keys other than those are skipped.
+// Results are the same as for_each_graph_in_file's, level for level.
+//
+// A type override changes the colors of the chains that use it, so when a
+// level's "type_overrides" comes after its "rules" (as it does in the files
+// we write, such as standard.json and cycle.json), the chains read so far are
+// fed into a fresh creator again once the overrides are known. Such a level's
+// rules are processed twice; only views of the chains are kept for that.
+//
+// Throws std::runtime_error if the text isn't json, or isn't shaped like a
+// level file, as well as for anything GraphCreator rejects.
+
+namespace p1 {
+
+// calls on_graph with each level's graph, compressed and grouped by colors,
+// in order, returning how many there were; the graphs use resource
+int parse_graphs(std::string_view            json_text,
+                 GraphCallback const &       on_graph,
+                 std::pmr::memory_resource * resource =
+                     std::pmr::get_default_resource());
+
+int parse_graphs_in_file(std::string const &   filename,
+                         GraphCallback const & on_graph);
+
+} // namespace p1
@@ -0,0 +1,372 @@
+#include "LevelStream.hpp"
+#include "GraphCreator.hpp"
+#include "MappedFile.hpp"
+
+#include <boost/json/basic_parser_impl.hpp>
+
+#include <cstdint>
+#include <new>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace p1 {
+using namespace boost;
+
+namespace {
+
+// Where a level's DOM goes once it outgrows the level buffer. It counts what
+// it hands out, so the buffer can grow to hold the next level that big.
+class OverflowResource : public json::memory_resource {
+public:
+  std::size_t
+  take_used() {
+    return std::exchange(used_, 0);
+  }
+
+private:
+  void *
+  do_allocate(std::size_t bytes, std::size_t align) override {
+    used_ += bytes;
+    return ::operator new(bytes, std::align_val_t(align));
+  }
+
+  void
+  do_deallocate(void * ptr, std::size_t bytes, std::size_t align) override {
+    ::operator delete(ptr, bytes, std::align_val_t(align));
+  }
+
+  bool
+  do_is_equal(json::memory_resource const & other) const noexcept override {
+    return this == &other;
+  }
+
+  std::size_t used_ = 0;
+};
+
+// For json::basic_parser, which checks the whole file: follows the outer
+// object and its "levels" array, and has each level built in a value_stack
+// (as json::parser builds a document), handing it on as soon as it is
+// complete. Values of other keys are parsed, but nothing is kept of them.
+class LevelSplitter {
+public:
+  static constexpr std::size_t max_object_size = std::size_t(-1);
+  static constexpr std::size_t max_array_size  = std::size_t(-1);
+  static constexpr std::size_t max_key_size    = std::size_t(-1);
+  static constexpr std::size_t max_string_size = std::size_t(-1);
+
+  explicit LevelSplitter(LevelCallback const & on_level)
+      : on_level_(on_level), level_buffer_(InitialLevelBuffer) {
+  }
+
+  int
+  num_levels() const {
+    return num_levels_;
+  }
+
+  bool
+  on_document_begin(json::error_code &) {
+    return true;
+  }
+
+  bool
+  on_document_end(json::error_code &) {
+    if (not found_levels_) {
+      throw std::runtime_error("Level file has no \"levels\" array");
+    }
+    return true;
+  }
+
+  bool
+  on_object_begin(json::error_code &) {
+    open(Within::Object);
+    return true;
+  }
+
+  bool
+  on_object_end(std::size_t size, json::error_code &) {
+    close(Within::Object, size);
+    return true;
+  }
+
+  bool
+  on_array_begin(json::error_code &) {
+    open(Within::Array);
+    return true;
+  }
+
+  bool
+  on_array_end(std::size_t size, json::error_code &) {
+    close(Within::Array, size);
+    return true;
+  }
+
+  bool
+  on_key_part(json::string_view part, std::size_t, json::error_code &) {
+    if (in_level()) {
+      stack_.push_chars(part);
+    }
+    else if (in_file_object()) {
+      key_.append(part);
+    }
+    return true;
+  }
+
+  bool
+  on_key(json::string_view part, std::size_t, json::error_code &) {
+    if (in_level()) {
+      stack_.push_key(part);
+    }
+    else if (in_file_object()) {
+      key_.append(part);
+      levels_next_ = key_ == "levels";
+      key_.clear();
+    }
+    return true;
+  }
+
+  bool
+  on_string_part(json::string_view part, std::size_t, json::error_code &) {
+    if (in_level()) {
+      stack_.push_chars(part);
+    }
+    return true;
+  }
+
+  bool
+  on_string(json::string_view part, std::size_t, json::error_code &) {
+    scalar([&] { stack_.push_string(part); });
+    return true;
+  }
+
+  bool
+  on_number_part(json::string_view, json::error_code &) {
+    return true;
+  }
+
+  bool
+  on_int64(std::int64_t number, json::string_view, json::error_code &) {
+    scalar([&] { stack_.push_int64(number); });
+    return true;
+  }
+
+  bool
+  on_uint64(std::uint64_t number, json::string_view, json::error_code &) {
+    scalar([&] { stack_.push_uint64(number); });
+    return true;
+  }
+
+  bool
+  on_double(double number, json::string_view, json::error_code &) {
+    scalar([&] { stack_.push_double(number); });
+    return true;
+  }
+
+  bool
+  on_bool(bool flag, json::error_code &) {
+    scalar([&] { stack_.push_bool(flag); });
+    return true;
+  }
+
+  bool
+  on_null(json::error_code &) {
+    scalar([&] { stack_.push_null(); });
+    return true;
+  }
+
+  bool
+  on_comment_part(json::string_view, json::error_code &) {
+    return true;
+  }
+
+  bool
+  on_comment(json::string_view, json::error_code &) {
+    return true;
+  }
+
+private:
+  enum class Within { Object, Array };
+
+  // where in the file the parser is, outside of levels and skipped values
+  enum class Where { Outside, File, Levels };
+
+  // Enough for most levels' DOMs. The buffer grows to fit any bigger level,
+  // so the arena only goes to the heap for the biggest level so far.
+  static constexpr std::size_t InitialLevelBuffer = 4096;
+
+  bool
+  in_level() const {
+    return level_depth_ > 0;
+  }
+
+  bool
+  in_file_object() const {
+    return where_ == Where::File && skip_depth_ == 0;
+  }
+
+  [[noreturn]] static void
+  fail(char const * what) {
+    throw std::runtime_error(std::string("Level file: ") + what);
+  }
+
+  void
+  open(Within within) {
+    bool const object = within == Within::Object;
+    if (in_level()) {
+      ++level_depth_;
+      return;
+    }
+    if (skip_depth_ > 0) {
+      ++skip_depth_;
+      return;
+    }
+    switch (where_) {
+    case Where::Outside:
+      if (not object) {
+        fail("expected an object");
+      }
+      where_ = Where::File;
+      break;
+    case Where::File:
+      if (not levels_next_) {
+        skip_depth_ = 1;
+      }
+      else if (object) {
+        fail("\"levels\" must be an array");
+      }
+      else {
+        found_levels_ = true;
+        where_        = Where::Levels;
+      }
+      break;
+    case Where::Levels:
+      if (not object) {
+        fail("each level must be an object");
+      }
+      begin_level();
+      break;
+    }
+  }
+
+  void
+  close(Within within, std::size_t size) {
+    if (in_level()) {
+      if (within == Within::Object) {
+        stack_.push_object(size);
+      }
+      else {
+        stack_.push_array(size);
+      }
+      if (--level_depth_ == 0) {
+        end_level();
+      }
+    }
+    else if (skip_depth_ > 0) {
+      --skip_depth_;
+    }
+    else {
+      where_ = where_ == Where::Levels ? Where::File : Where::Outside;
+    }
+  }
+
+  // push adds the value to the level being built, if there is one; other
+  // scalars only have to be somewhere the file allows them
+  template <typename PushT>
+  void
+  scalar(PushT push) {
+    if (in_level()) {
+      push();
+    }
+    else if (skip_depth_ == 0) {
+      switch (where_) {
+      case Where::Outside:
+        fail("expected an object");
+      case Where::File:
+        if (levels_next_) {
+          fail("\"levels\" must be an array");
+        }
+        break;
+      case Where::Levels:
+        fail("each level must be an object");
+      }
+    }
+  }
+
+  // Each level's DOM is built in an arena over the one level buffer, and
+  // dropped in one go once on_level is done with it.
+  void
+  begin_level() {
+    arena_.emplace(level_buffer_.data(), level_buffer_.size(), &overflow_);
+    stack_.reset(&*arena_);
+    level_depth_ = 1;
+  }
+
+  void
+  end_level() {
+    {
+      json::value level = stack_.release();
+      on_level_(level.as_object());
+    }
+    arena_.reset();
+    level_buffer_.resize(level_buffer_.size() + overflow_.take_used());
+    ++num_levels_;
+  }
+
+  LevelCallback const & on_level_;
+
+  Where       where_        = Where::Outside;
+  int         skip_depth_   = 0; // within a value of another key of the file
+  int         level_depth_  = 0; // within a level
+  bool        levels_next_  = false;
+  bool        found_levels_ = false;
+  int         num_levels_   = 0;
+  std::string key_;
+
+  std::vector<unsigned char>              level_buffer_;
+  OverflowResource                        overflow_;
+  std::optional<json::monotonic_resource> arena_;
+  json::value_stack                       stack_;
+};
+
+} // namespace
+
+int
+for_each_level(std::string_view json_text, LevelCallback const & on_level) {
+  json::basic_parser<LevelSplitter> parser(json::parse_options(), on_level);
+  json::error_code                  ec;
+  auto const                        used =
+      parser.write_some(false, json_text.data(), json_text.size(), ec);
+  // write_some stops after the first document; anything but whitespace after
+  // it is an error, as it is to json::parse
+  if (not ec && used != json_text.size()) {
+    ec = json::error::extra_data;
+  }
+  if (ec) {
+    throw std::runtime_error("Level file: " + ec.message() + " at offset " +
+                             std::to_string(used));
+  }
+  return parser.handler().num_levels();
+}
+
+int
+for_each_level_in_file(std::string const &  filename,
+                       LevelCallback const & on_level) {
+  MappedFile file(filename);
+  return for_each_level(file.contents(), on_level);
+}
+
+int
+for_each_graph_in_file(std::string const &  filename,
+                       GraphCallback const & on_graph) {
+  return for_each_level_in_file(
+      filename, [&](json::object const & level) {
+        on_graph(GraphCreator(level)
+                     .compress_vertices()
+                     .group_by_colors()
+                     .create());
+      });
+}
+
+} // namespace p1
@@ -0,0 +1,41 @@
+#pragma once
+
+#include "Graph.hpp"
+
+#include <boost/json.hpp>
+#include <functional>
+#include <string>
+#include <string_view>
+
+// Streaming alternative to create_graphs: rather than parsing the whole file
+// into one json::value first, the file goes through a json::basic_parser
+// whose handler builds only the elements of the "levels" array, one at a
+// time, each handed to the callback and freed before the next. Memory use is
+// one level's DOM (and graph), however many levels the file has; the file
+// itself is read through a MappedFile. Each DOM is built in the same reused
+// buffer, so once the largest level has been seen, parsing a level allocates
+// nothing, and dropping it frees nothing. The object handed to the callback
+// is only good until it returns.
+//
+// The whole file is parsed, so it must all be valid json, but nothing outside
+// the "levels" array is kept. Throws std::runtime_error if the text isn't
+// json, or isn't an object with a "levels" array of objects.
+
+namespace p1 {
+
+using LevelCallback = std::function<void(boost::json::object const & level)>;
+using GraphCallback = std::function<void(Graph && graph)>;
+
+// calls on_level with each element of the "levels" array of json_text, in
+// order, returning how many there were
+int for_each_level(std::string_view json_text, LevelCallback const & on_level);
+
+int for_each_level_in_file(std::string const &  filename,
+                           LevelCallback const & on_level);
+
+// as for_each_level_in_file, building each level's graph as create_graphs
+// does (compressed and grouped by colors) and handing it to on_graph
+int for_each_graph_in_file(std::string const &  filename,
+                           GraphCallback const & on_graph);
+
+} // namespace p1
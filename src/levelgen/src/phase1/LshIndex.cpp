@@ -0,0 +1,64 @@
+#include "LshIndex.hpp"
+#include "hash_utils.hpp"
+
+#include <algorithm>
+#include <stdexcept>
+#include <string>
+
+LshIndex::LshIndex(int bands) : bands_(bands), rows_(0) {
+  if (bands <= 0 || minhash::SignatureSize % bands != 0) {
+    throw std::runtime_error("LshIndex: " + std::to_string(bands) +
+                             " bands do not evenly divide signature size " +
+                             std::to_string(minhash::SignatureSize));
+  }
+  rows_ = minhash::SignatureSize / bands;
+  band_tables_.resize(bands_);
+}
+
+std::uint64_t
+LshIndex::band_key(minhash::Signature const & signature, int band) const {
+  std::uint64_t key = band;
+  for (int row = band * rows_, end = row + rows_; row != end; ++row) {
+    key = hashing::combine(key, signature[row]);
+  }
+  return key;
+}
+
+LshIndex::Id
+LshIndex::insert(minhash::Signature const & signature) {
+  Id id = signatures_.size();
+  signatures_.push_back(signature);
+  for (int band = 0; band < bands_; ++band) {
+    band_tables_[band][band_key(signature, band)].push_back(id);
+  }
+  return id;
+}
+
+LshIndex::CandidateVec
+LshIndex::query(minhash::Signature const & signature,
+                double                     min_similarity) const {
+  std::vector<Id> ids;
+  for (int band = 0; band < bands_; ++band) {
+    auto const & table = band_tables_[band];
+    if (auto it = table.find(band_key(signature, band)); it != table.end()) {
+      ids.insert(ids.end(), it->second.begin(), it->second.end());
+    }
+  }
+  std::sort(begin(ids), end(ids));
+  ids.erase(std::unique(begin(ids), end(ids)), end(ids));
+
+  CandidateVec candidates;
+  for (Id id : ids) {
+    double similarity =
+        minhash::estimate_similarity(signature, signatures_[id]);
+    if (similarity >= min_similarity) {
+      candidates.push_back({id, similarity});
+    }
+  }
+  std::stable_sort(begin(candidates),
+                   end(candidates),
+                   [](Candidate const & c1, Candidate const & c2) {
+                     return c1.similarity > c2.similarity;
+                   });
+  return candidates;
+}
@@ -0,0 +1,62 @@
+#pragma once
+
+#include "MinHash.hpp"
+
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+// Locality sensitive hashing over MinHash signatures. Each signature is split
+// into bands of consecutive rows, and each band is hashed into its own bucket
+// table. Two signatures become candidates if any band matches exactly, which
+// happens with high probability when their similarity is above roughly
+// (1/bands)^(1/rows), and rarely when it is far below. Queries only look at
+// colliding buckets rather than every indexed signature.
+
+class LshIndex {
+public:
+  using Id = int;
+
+  struct Candidate {
+    Id     id;
+    double similarity; // estimated Jaccard similarity
+  };
+  using CandidateVec = std::vector<Candidate>;
+
+  static constexpr int DefaultBands = 16;
+
+  // bands must evenly divide minhash::SignatureSize
+  explicit LshIndex(int bands = DefaultBands);
+
+  // returns the id of the added signature; ids are assigned sequentially
+  // from 0, in insertion order.
+  Id insert(minhash::Signature const & signature);
+
+  // All indexed signatures sharing at least one band with the given one and
+  // whose estimated similarity is at least min_similarity, most similar
+  // first (ties in id order).
+  CandidateVec query(minhash::Signature const & signature,
+                     double                     min_similarity = 0.0) const;
+
+  int
+  size() const {
+    return signatures_.size();
+  }
+
+  minhash::Signature const &
+  signature(Id id) const {
+    return signatures_[id];
+  }
+
+private:
+  std::uint64_t band_key(minhash::Signature const & signature, int band) const;
+
+private:
+  using Bucket    = std::vector<Id>;
+  using BandTable = std::unordered_map<std::uint64_t, Bucket>;
+
+  int                             bands_;
+  int                             rows_;
+  std::vector<BandTable>          band_tables_;
+  std::vector<minhash::Signature> signatures_;
+};
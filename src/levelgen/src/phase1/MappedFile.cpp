@@ -0,0 +1,82 @@
+#include "MappedFile.hpp"
+
+#include <cerrno>
+#include <cstring>
+#include <stdexcept>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+static std::runtime_error
+file_error(char const * what, std::string const & filename) {
+  return std::runtime_error(std::string(what) + " " + filename + ": " +
+                            std::strerror(errno));
+}
+
+MappedFile::MappedFile(std::string const & filename) {
+  bool const from_stdin = filename == "-";
+  int const  fd =
+      from_stdin ? STDIN_FILENO : ::open(filename.c_str(), O_RDONLY);
+  if (fd == -1) {
+    throw file_error("Cannot open", filename);
+  }
+
+  struct stat st;
+  if (::fstat(fd, &st) == 0 && S_ISREG(st.st_mode) && st.st_size > 0) {
+    void * addr = ::mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (addr != MAP_FAILED) {
+      ::madvise(addr, st.st_size, MADV_SEQUENTIAL);
+      data_   = static_cast<char const *>(addr);
+      size_   = st.st_size;
+      mapped_ = true;
+    }
+  }
+
+  try {
+    if (not mapped_) {
+      read_all(fd, filename);
+    }
+  }
+  catch (...) {
+    if (not from_stdin) {
+      ::close(fd);
+    }
+    throw;
+  }
+  // a mapping stays valid after its descriptor is closed
+  if (not from_stdin) {
+    ::close(fd);
+  }
+}
+
+MappedFile::~MappedFile() {
+  if (mapped_) {
+    ::munmap(const_cast<char *>(data_), size_);
+  }
+}
+
+void
+MappedFile::read_all(int fd, std::string const & filename) {
+  constexpr std::size_t ChunkSize = 1 << 16;
+
+  for (;;) {
+    auto const old_size = buffer_.size();
+    buffer_.resize(old_size + ChunkSize);
+    auto const got = ::read(fd, buffer_.data() + old_size, ChunkSize);
+    if (got < 0 && errno == EINTR) {
+      buffer_.resize(old_size);
+      continue;
+    }
+    if (got < 0) {
+      throw file_error("Cannot read", filename);
+    }
+    buffer_.resize(old_size + got);
+    if (got == 0) {
+      break;
+    }
+  }
+  data_ = buffer_.data();
+  size_ = buffer_.size();
+}
@@ -0,0 +1,40 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+#include <string_view>
+
+// The whole contents of a file, read-only. Regular files are memory mapped,
+// so parsing reads straight from the page cache (shared with any other
+// process reading the same file) rather than from a private copy. Anything
+// that can't be mapped, such as a pipe, or "-" for standard input, is read
+// into memory instead. Throws std::runtime_error if the file can't be opened
+// or read.
+
+class MappedFile {
+public:
+  explicit MappedFile(std::string const & filename);
+  ~MappedFile();
+
+  MappedFile(MappedFile const &)             = delete;
+  MappedFile & operator=(MappedFile const &) = delete;
+
+  std::string_view
+  contents() const {
+    return {data_, size_};
+  }
+
+  // false if the contents were read rather than mapped
+  bool
+  is_mapped() const {
+    return mapped_;
+  }
+
+private:
+  void read_all(int fd, std::string const & filename);
+
+  char const * data_   = nullptr;
+  std::size_t  size_   = 0;
+  bool         mapped_ = false;
+  std::string  buffer_; // the contents, when not mapped
+};
@@ -0,0 +1,64 @@
+#pragma once
+
+#include "hash_utils.hpp"
+
+#include <array>
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+// A MinHash signature summarizes a set of features (see Graph::wl_features) in
+// a fixed number of values. The fraction of positions where two signatures
+// agree is an unbiased estimate of the Jaccard similarity of the two sets,
+// without needing the sets themselves.
+
+namespace minhash {
+
+static constexpr int SignatureSize = 64;
+
+using Feature    = std::uint64_t;
+using FeatureVec = std::vector<Feature>;
+using Signature  = std::array<std::uint64_t, SignatureSize>;
+
+namespace detail {
+
+constexpr std::array<std::uint64_t, SignatureSize>
+make_seeds() {
+  std::array<std::uint64_t, SignatureSize> seeds{};
+  for (int i = 0; i < SignatureSize; ++i) {
+    seeds[i] = hashing::mix(i + 1);
+  }
+  return seeds;
+}
+
+inline constexpr auto Seeds = make_seeds();
+
+} // namespace detail
+
+// Each position i is the minimum, over all features, of an independent hash
+// function h_i(feature). An empty feature set yields all-max values.
+inline Signature
+compute(FeatureVec const & features) {
+  Signature signature;
+  signature.fill(std::numeric_limits<std::uint64_t>::max());
+  for (Feature feature : features) {
+    for (int i = 0; i < SignatureSize; ++i) {
+      auto h = hashing::mix(feature ^ detail::Seeds[i]);
+      if (h < signature[i]) {
+        signature[i] = h;
+      }
+    }
+  }
+  return signature;
+}
+
+inline double
+estimate_similarity(Signature const & sig1, Signature const & sig2) {
+  int same = 0;
+  for (int i = 0; i < SignatureSize; ++i) {
+    same += sig1[i] == sig2[i];
+  }
+  return double(same) / SignatureSize;
+}
+
+} // namespace minhash
@@ -0,0 +1,108 @@
+#pragma once
+
+#include "Vertex.hpp"
+
+#include <cassert>
+
+// How same-color runs are merged into single vertices, for GraphCreator at run
+// time and StaticGraph at compile time alike, so both compress a level the
+// same way. merge_runs works on a graph that provides:
+//
+//   int  size() const
+//   int  visit_parents_of(int idx, cb)   calls cb(parent), returns indegree
+//   void visit_children_of(int idx, cb)  calls cb(child)
+//   bool try_to_merge(int from_idx, int to_idx)
+//
+// try_to_merge merges to_idx into from_idx, its only parent, if their colors
+// allow: to_idx's blocks go onto the end of from_idx's run (see append_blocks)
+// and its children to from_idx, and then to_idx is removed by moving the last
+// vertex into its place. It returns whether it merged. Only the graphs differ
+// in how vertices, runs and edges are stored.
+
+namespace run_merge {
+
+// Appends the blocks of one vertex or continuation record to the run made of
+// head and its continuation records, spilling into a new record of head's
+// color each time the last one fills.
+template <typename RecordsT>
+constexpr void
+append_blocks(vertex::Vertex & head, RecordsT & records,
+              vertex::Vertex blocks) {
+  auto const color_bits = +head & (vertex::ColorMask << vertex::ColorShift);
+  while (vertex::size(blocks) > 0) {
+    auto & tail = records.empty() ? head : records.back();
+    if (is_full(tail)) {
+      records.push_back(vertex::Vertex{color_bits});
+      continue;
+    }
+    int num_merged = num_can_merge(tail, blocks);
+    tail           = create_merged(tail, blocks);
+    blocks         = pop_front(blocks, num_merged);
+  }
+}
+
+// Merges every vertex with one parent into that parent, wherever the colors
+// allow, until none is left. Rather than sweeping every vertex until nothing
+// changes, a worklist holds the vertices whose (parent, vertex) pair may still
+// merge. A merge only changes the parent and the merged vertex, so only the
+// parent and its children (which, after a removal, include the removed
+// vertex's children) need another look.
+//
+// worklist needs push_back, front, pop_front and empty, and starts empty; it
+// never holds more entries than the graph starts with vertices. queued is
+// indexed by vertex and at least that long.
+template <typename GraphT, typename WorklistT, typename FlagsT>
+constexpr void
+merge_runs(GraphT & graph, WorklistT & worklist, FlagsT & queued) {
+  for (int idx = 0, sz = graph.size(); idx < sz; ++idx) {
+    worklist.push_back(idx);
+    queued[idx] = true;
+  }
+  auto enqueue = [&](int idx) {
+    if (not queued[idx]) {
+      queued[idx] = true;
+      worklist.push_back(idx);
+    }
+  };
+
+  while (not worklist.empty()) {
+    int cur_idx = worklist.front();
+    worklist.pop_front();
+    // stale: this index was vacated by a removal, or handed to another vertex
+    if (cur_idx >= graph.size() || not queued[cur_idx]) {
+      continue;
+    }
+    queued[cur_idx] = false;
+
+    int source_idx = -1;
+    int indegree   = graph.visit_parents_of(
+        cur_idx, [&](int src_idx) { source_idx = src_idx; });
+    if (indegree != 1) {
+      continue;
+    }
+    assert(source_idx != -1);
+
+    int const last_idx = graph.size() - 1;
+    if (not graph.try_to_merge(source_idx, cur_idx)) {
+      continue;
+    }
+
+    // a merge always removes cur, and the last vertex moves into its place
+    assert(graph.size() == last_idx);
+    if (queued[last_idx]) {
+      queued[last_idx] = false;
+      if (last_idx != cur_idx) {
+        enqueue(cur_idx);
+      }
+    }
+    // the source may have been the vertex that moved
+    if (source_idx == last_idx) {
+      source_idx = cur_idx;
+    }
+
+    enqueue(source_idx);
+    graph.visit_children_of(source_idx, enqueue);
+  }
+}
+
+} // namespace run_merge
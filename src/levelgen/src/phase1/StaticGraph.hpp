@@ -0,0 +1,419 @@
+#pragma once
+
+#include "AdjacencyMatrix.hpp"
+#include "Block.hpp"
+#include "ChainWalk.hpp"
+#include "Color.hpp"
+#include "Fingerprint.hpp"
+#include "Graph.hpp"
+#include "RuleSide.hpp"
+#include "RunMerge.hpp"
+#include "Transforms.hpp"
+#include "Vertex.hpp"
+#include "Vertices.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <span>
+#include <utility>
+
+// A level graph built entirely at compile time from a rule literal, for
+// reference levels and fixtures that shouldn't cost anything at startup:
+//
+//   using namespace static_graph;
+//   constexpr auto graph = StaticGraph<8>::build(
+//       rules(from("a") = to("bc"),
+//             from("b") = to("")));
+//   static_assert(graph.size() == 4);
+//
+// Chains become vertices through the same chain_walk::walk and
+// transforms::transform as in GraphCreator, runs merge through the same
+// run_merge::merge_runs (continuation records included), and vertices are
+// grouped by the same Vertices::sort_key, all on fixed-size arrays, so that
+// fingerprint() matches Graph::fingerprint() of the same level built at run
+// time, and to_graph() gives an isomorphic Graph. Only the default transforms
+// are available (no type_overrides). Anything that can't be built is a compile
+// error.
+
+namespace static_graph {
+
+constexpr std::size_t MaxToChains = 8;
+
+// One rule: from -> each of to[0, num_to)
+struct Rule {
+  std::string_view                          from;
+  std::array<std::string_view, MaxToChains> to{};
+  int                                       num_to = 0;
+};
+
+// The same shape as the test::json DSL:  from("a") = to("bc", "")
+struct to {
+  template <typename... StringT>
+  constexpr to(StringT... chains)
+      : chains_{std::string_view(chains)...}, num_chains_(sizeof...(chains)) {
+    static_assert(sizeof...(chains) <= MaxToChains);
+  }
+
+  std::array<std::string_view, MaxToChains> chains_;
+  int                                       num_chains_;
+};
+
+struct from {
+  std::string_view from_;
+
+  constexpr Rule
+  operator=(to const & to_chains) const {
+    return {from_, to_chains.chains_, to_chains.num_chains_};
+  }
+};
+
+template <typename... RuleT>
+constexpr std::array<Rule, sizeof...(RuleT)>
+rules(RuleT... each_rule) {
+  return {each_rule...};
+}
+
+// MaxVertices bounds the vertices before compression, i.e. one per distinct
+// chain suffix, as well as after.
+template <std::size_t MaxVertices>
+class StaticGraph {
+public:
+  template <std::size_t NumRules>
+  static consteval StaticGraph
+  build(std::array<Rule, NumRules> const & level_rules) {
+    StaticGraph graph;
+    for (Rule const & rule : level_rules) {
+      int prev_idx = graph.process_chain(rule.from, RuleSide::FROM, -1);
+      for (int i = 0; i < rule.num_to; ++i) {
+        graph.process_chain(rule.to[i], RuleSide::TO, prev_idx);
+      }
+    }
+    graph.compress_vertices();
+    graph.group_by_colors();
+    return graph;
+  }
+
+  constexpr int
+  size() const {
+    return size_;
+  }
+
+  constexpr vertex::Vertex
+  vertex_at(int idx) const {
+    return vertices_[idx];
+  }
+
+  // see Vertices::continuation_of
+  constexpr std::span<vertex::Vertex const>
+  continuation_of(int idx) const {
+    return records_[idx].span();
+  }
+
+  // the chain suffix that names the vertex, without its color prefix
+  constexpr std::string_view
+  name_of(int idx) const {
+    return names_[idx];
+  }
+
+  constexpr bool
+  has_edge(int from_idx, int to_idx) const {
+    return edges_[from_idx][to_idx];
+  }
+
+  constexpr fingerprint::Hash
+  fingerprint() const {
+    return fingerprint::compute(
+        size_,
+        [this](int i) {
+          return fingerprint::run_label(vertices_[i], continuation_of(i));
+        },
+        [this](int i, int j) { return edges_[i][j]; });
+  }
+
+  // A run-time Graph of the image, without parsing, transforming or looking
+  // up any names.
+  Graph
+  to_graph(std::string level_name = "static") const {
+    Vertices vertices;
+    for (int i = 0; i < size_; ++i) {
+      auto v      = vertices_[i];
+      auto offset = vertices.add_name_text(names_[i]);
+      auto role   = get_start_bit(v) ? vertex::VertexRole::START
+                                     : vertex::VertexRole::INTERNAL;
+      vertices.append_vertex(offset, names_[i].size(), get_block(v, 0),
+                             get_final_color(v), role);
+      vertices.set_vertex(i, v);
+      vertices.set_continuation(i, continuation_of(i));
+    }
+
+    matrix::AdjacencyMatrix adjacency_matrix(size_);
+    for (int i = 0; i < size_; ++i) {
+      for (int j = 0; j < size_; ++j) {
+        if (edges_[i][j]) {
+          adjacency_matrix.add_edge(i, j);
+        }
+      }
+    }
+    return Graph(std::move(vertices), std::move(adjacency_matrix),
+                 std::move(level_name));
+  }
+
+private:
+  using EdgeRow = std::array<bool, MaxVertices>;
+
+  // A run holds at most one block per vertex before compression, so this many
+  // records is enough for any vertex's continuation.
+  static constexpr std::size_t MaxRecords =
+      MaxVertices / vertex::MaxBlocksPerVertex;
+
+  // A vertex's continuation records, as run_merge::append_blocks builds them
+  struct Records {
+    std::array<vertex::Vertex, MaxRecords> values{};
+    std::size_t                            size = 0;
+
+    constexpr bool
+    empty() const {
+      return size == 0;
+    }
+
+    constexpr vertex::Vertex &
+    back() {
+      return values[size - 1];
+    }
+
+    constexpr void
+    push_back(vertex::Vertex record) {
+      if (size == MaxRecords) {
+        throw std::runtime_error("Too many continuation records");
+      }
+      values[size++] = record;
+    }
+
+    constexpr std::span<vertex::Vertex const>
+    span() const {
+      return {values.data(), size};
+    }
+  };
+
+  // run_merge::merge_runs's worklist. It never holds more entries than there
+  // are vertices to start with, so a ring of MaxVertices does.
+  struct Worklist {
+    std::array<int, MaxVertices> items{};
+    std::size_t                  head  = 0;
+    std::size_t                  count = 0;
+
+    constexpr bool
+    empty() const {
+      return count == 0;
+    }
+
+    constexpr int
+    front() const {
+      return items[head];
+    }
+
+    constexpr void
+    pop_front() {
+      head = (head + 1) % MaxVertices;
+      --count;
+    }
+
+    constexpr void
+    push_back(int idx) {
+      if (count == MaxVertices) {
+        throw std::runtime_error("StaticGraph worklist overflow");
+      }
+      items[(head + count++) % MaxVertices] = idx;
+    }
+  };
+
+  constexpr StaticGraph() = default;
+
+  constexpr int
+  find(std::string_view suffix, RuleSide side) const {
+    for (int i = 0; i < size_; ++i) {
+      if (names_[i] == suffix && sides_[i] == side) {
+        return i;
+      }
+    }
+    return -1;
+  }
+
+  // For chain_walk::walk, as GraphCreator::process_chain but with a vertex per
+  // distinct suffix text, the same thing when there are no type_overrides.
+  struct Builder {
+    StaticGraph &    graph;
+    std::string_view chain;
+    RuleSide         side;
+
+    constexpr int
+    find_vertex(int i) const {
+      return graph.find(chain.substr(i), side);
+    }
+
+    constexpr int
+    add_vertex(int i, vertex::VertexRole role) {
+      if (graph.size_ == MaxVertices) {
+        throw std::runtime_error("Too many vertices for StaticGraph");
+      }
+      auto [block, color] =
+          transforms::transform(transforms::DefaultBlockColors, chain[i], side);
+
+      int idx              = graph.size_++;
+      graph.names_[idx]    = chain.substr(i);
+      graph.sides_[idx]    = side;
+      graph.vertices_[idx] = vertex::create(color, block, role);
+      return idx;
+    }
+
+    constexpr void
+    mark_start(int idx) {
+      graph.vertices_[idx] = set_start_bit(graph.vertices_[idx]);
+    }
+
+    constexpr void
+    add_edge(int from_idx, int to_idx) {
+      graph.edges_[from_idx][to_idx] = true;
+    }
+  };
+
+  constexpr int
+  process_chain(std::string_view chain, RuleSide side, int prev_idx) {
+    chain = chain_walk::nonempty(chain);
+    Builder builder{*this, chain, side};
+    return chain_walk::walk(builder, chain, side, prev_idx);
+  }
+
+  // The graph run_merge::merge_runs works on, over the arrays here
+  struct Merger {
+    StaticGraph & graph;
+
+    constexpr int
+    size() const {
+      return graph.size_;
+    }
+
+    template <typename CallbackT>
+    constexpr int
+    visit_parents_of(int idx, CallbackT cb) const {
+      int indegree = 0;
+      for (int i = 0; i < graph.size_; ++i) {
+        if (graph.edges_[i][idx]) {
+          cb(i);
+          ++indegree;
+        }
+      }
+      return indegree;
+    }
+
+    template <typename CallbackT>
+    constexpr void
+    visit_children_of(int idx, CallbackT cb) const {
+      for (int i = 0; i < graph.size_; ++i) {
+        if (graph.edges_[idx][i]) {
+          cb(i);
+        }
+      }
+    }
+
+    constexpr bool
+    try_to_merge(int from_idx, int to_idx) {
+      return graph.try_to_merge(from_idx, to_idx);
+    }
+  };
+
+  // as GraphCreator::compress_vertices
+  constexpr void
+  compress_vertices() {
+    Worklist                      worklist;
+    std::array<bool, MaxVertices> queued{};
+    Merger                        merger{*this};
+    run_merge::merge_runs(merger, worklist, queued);
+  }
+
+  // as GraphCreator::try_to_merge and remove_vertex
+  constexpr bool
+  try_to_merge(int from_idx, int to_idx) {
+    if (from_idx == to_idx ||
+        not vertex::vertices_are_mergeable(vertices_[from_idx],
+                                           vertices_[to_idx])) {
+      return false;
+    }
+    run_merge::append_blocks(vertices_[from_idx], records_[from_idx],
+                             vertices_[to_idx]);
+    for (auto record : continuation_of(to_idx)) {
+      run_merge::append_blocks(vertices_[from_idx], records_[from_idx],
+                               record);
+    }
+
+    for (int child = 0; child < size_; ++child) {
+      if (edges_[to_idx][child]) {
+        edges_[from_idx][child] = true;
+        edges_[to_idx][child]   = false;
+      }
+    }
+    edges_[from_idx][to_idx] = false;
+    move_vertex(size_ - 1, to_idx);
+    --size_;
+    return true;
+  }
+
+  // as Vertices::compute_sorted_index_map, with the index breaking ties
+  constexpr void
+  group_by_colors() {
+    std::array<std::pair<std::uint64_t, int>, MaxVertices> keys{};
+    for (int i = 0; i < size_; ++i) {
+      keys[i] = {Vertices::sort_key(vertices_[i]), i};
+    }
+    std::sort(keys.begin(), keys.begin() + size_);
+
+    StaticGraph sorted;
+    sorted.size_ = size_;
+    for (int i = 0; i < size_; ++i) {
+      int from            = keys[i].second;
+      sorted.vertices_[i] = vertices_[from];
+      sorted.records_[i]  = records_[from];
+      sorted.names_[i]    = names_[from];
+      sorted.sides_[i]    = sides_[from];
+      for (int j = 0; j < size_; ++j) {
+        sorted.edges_[i][j] = edges_[from][keys[j].second];
+      }
+    }
+    *this = sorted;
+  }
+
+  // to_idx <= from_idx, and to_idx's old row and column are dropped
+  constexpr void
+  move_vertex(int from_idx, int to_idx) {
+    if (from_idx == to_idx) {
+      return;
+    }
+    vertices_[to_idx] = vertices_[from_idx];
+    records_[to_idx]  = records_[from_idx];
+    names_[to_idx]    = names_[from_idx];
+    sides_[to_idx]    = sides_[from_idx];
+    for (int i = 0; i < size_; ++i) {
+      edges_[to_idx][i]   = edges_[from_idx][i];
+      edges_[from_idx][i] = false;
+    }
+    for (int i = 0; i < size_; ++i) {
+      edges_[i][to_idx]   = edges_[i][from_idx];
+      edges_[i][from_idx] = false;
+    }
+  }
+
+private:
+  int                                       size_ = 0;
+  std::array<vertex::Vertex, MaxVertices>   vertices_{};
+  std::array<Records, MaxVertices>          records_{};
+  std::array<std::string_view, MaxVertices> names_{};
+  std::array<RuleSide, MaxVertices>         sides_{};
+  std::array<EdgeRow, MaxVertices>          edges_{};
+};
+
+} // namespace static_graph
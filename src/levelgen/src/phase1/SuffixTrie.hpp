@@ -0,0 +1,61 @@
+#pragma once
+
+#include "Color.hpp"
+
+#include <cstdint>
+#include <memory_resource>
+#include <unordered_map>
+
+// A trie over chain suffixes, read back to front, so chains that end the same
+// way share the nodes for their common tail. Each symbol is a block char along
+// with the final color it was given, so "from" and "to" chains never share.
+//
+// a -> bcd       root <- d <- c <- b
+// b -> cd                      ^-- "cd" is this node in both rules
+//
+// Stepping to a node is one hash lookup however long the suffix it stands
+// for, so a chain of n blocks costs O(n) instead of the O(n^2) of hashing
+// each of its suffixes as a name.  Nodes are numbered densely from Root, so
+// callers can keep per-node data in a plain vector.
+
+class SuffixTrie {
+public:
+  using NodeId = int;
+
+  // the empty suffix
+  static constexpr NodeId Root = 0;
+
+  explicit SuffixTrie(std::pmr::memory_resource * resource =
+                          std::pmr::get_default_resource())
+      : children_(resource) {
+  }
+
+  // The node for the suffix made of (ch, final_color) followed by the suffix
+  // at tail; created if not seen before.
+  NodeId
+  extend(NodeId tail, char ch, color::FinalColor final_color) {
+    auto [iter, inserted] = children_.try_emplace(key(tail, ch, final_color),
+                                                  num_nodes_);
+    if (inserted) {
+      ++num_nodes_;
+    }
+    return iter->second;
+  }
+
+  // including Root
+  int
+  size() const {
+    return num_nodes_;
+  }
+
+private:
+  static std::uint64_t
+  key(NodeId tail, char ch, color::FinalColor final_color) {
+    return std::uint64_t(tail) << 16 |
+           std::uint64_t(static_cast<std::uint8_t>(final_color)) << 8 |
+           static_cast<std::uint8_t>(ch);
+  }
+
+  std::pmr::unordered_map<std::uint64_t, NodeId> children_;
+  int                                            num_nodes_ = 1;
+};
@@ -4,11 +4,16 @@
 #include "Color.hpp"
 #include "VertexBitConstants.hpp"
 
+#include <array>
 #include <cassert>
 #include <cstdint>
+#include <memory>
+#include <stdexcept>
+#include <string>
 #include <string_view>
 #include <tuple>
-#include <map>
+#include <unordered_map>
+#include <vector>
 
 #include "boost/json.hpp"
 
@@ -20,26 +25,119 @@
 
   2) break separate "colors" apart into separate vertex nodes
 
+  The tables for the built-in colors are the same for every level, so they
+  are built once, at compile time, and shared. A level's type_overrides only
+  ever change which color a block char has, so a Transforms with overrides
+  holds its own copy of just that table, made on the first override (and
+  again on the next one after the Transforms was copied).
  */
 
+namespace transforms {
+
+using Color = color::Color;
+
+// indexed by block char
+using BlockColorTable = std::array<Color, 256>;
+using BlockCharTable  = std::array<char, 256>;
+
+// indexed by color
+using ColorCharTable = std::array<char, vertex::MaxColors>;
+
+constexpr std::uint8_t
+index(char block) {
+  return static_cast<std::uint8_t>(block);
+}
+
+// given a block (char) what is its color
+constexpr BlockColorTable
+make_block_colors() {
+  BlockColorTable table{};
+  for (auto & e : table) {
+    e = Color::DEFAULT;
+  }
+  table[index(block::NOTHING_BLOCK_CHAR)] = Color::NOTHING;
+  table['.']                              = Color::WILDCARD;
+  for (char c = '1'; c <= '9'; ++c) {
+    table[index(c)] = Color::BACKREF;
+  }
+  return table;
+}
+
+// given a block (char) fixup (adj value to be 0-based by...)
+constexpr BlockCharTable
+make_block_fixups() {
+  BlockCharTable table{};
+  for (auto & e : table) {
+    e = 'a'; // assume letters are the main units
+  }
+  table[index(block::NOTHING_BLOCK_CHAR)] = '!';
+  table['.']                              = '.';
+  for (char c = '1'; c <= '9'; ++c) {
+    table[index(c)] = '1';
+  }
+  return table;
+}
+
+// given a color, get the offset to convert a block back to a char to
+// reverse a transform back to original char
+constexpr ColorCharTable
+make_color_unfixups() {
+  ColorCharTable table{};
+  for (auto & e : table) {
+    // solid rects, and customs, all use 'a' as base
+    e = 'a';
+  }
+  table[+Color::NOTHING]  = '!';
+  table[+Color::WILDCARD] = '.';
+  table[+Color::BACKREF]  = '1';
+  return table;
+}
+
+inline constexpr BlockColorTable DefaultBlockColors   = make_block_colors();
+inline constexpr BlockCharTable  DefaultBlockFixups   = make_block_fixups();
+inline constexpr ColorCharTable  DefaultColorUnfixups = make_color_unfixups();
+
+// The fixups are the same with or without overrides, so these serve every
+// level, and compile-time code (see StaticGraph.hpp) too.
+constexpr block::FinalBlock
+finalize_block(char block) {
+  auto transformed = block - DefaultBlockFixups[index(block)] + 1;
+  assert((transformed & ~vertex::BlockMask) == 0);
+  return block::FinalBlock{std::uint8_t(transformed)};
+}
+
+constexpr char
+unfinalize_block(block::FinalBlock block, color::FinalColor color) {
+  return +block + DefaultColorUnfixups[+get_color(color)] - 1;
+}
+
+// The final block and color for a block char, given its level's block colors
+// (DefaultBlockColors for a level without type_overrides).
+constexpr std::tuple<block::FinalBlock, color::FinalColor>
+transform(BlockColorTable const & block_colors, char block, RuleSide side) {
+  return {finalize_block(block),
+          color::to_final_color(block_colors[index(block)], side)};
+}
+
+} // namespace transforms
+
 class Transforms {
 public:
-  using Color          = color::Color;
-  using ColorNames     = std::vector<std::string>;
-  using const_iterator = ColorNames::const_iterator;
+  using Color           = color::Color;
+  using ColorNames      = std::vector<std::string>;
+  using const_iterator  = ColorNames::const_iterator;
+  using BlockColorTable = transforms::BlockColorTable;
 
-  Transforms() {
-    init_block_maps();
-  }
+  Transforms() = default;
 
   void
   add_level_type_override(char block, boost::json::object const & type_config) {
     auto const & type = type_config.at("type").as_string();
     if (type == "RotatingColors") {
-      auto cycle_chars           = type_config.at("cycle_chars").as_string();
-      auto custom_name           = "RotCol:" + std::string{cycle_chars};
-      auto color                 = get_or_create_color_by_name(custom_name);
-      block_to_color_map_[block] = color;
+      auto cycle_chars = type_config.at("cycle_chars").as_string();
+      auto custom_name = "RotCol:" + std::string{cycle_chars};
+      auto color       = get_or_create_color_by_name(custom_name);
+      writable_block_colors()[transforms::index(block)] = color;
     }
     else {
       throw std::runtime_error("Unknown type_override: " + std::string(type));
@@ -48,7 +146,8 @@ public:
 
   color::FinalColor
   to_color(char block, RuleSide side) const {
-    return color::to_final_color(block_to_color_map_[block], side);
+    auto base_color = (*block_to_color_map_)[transforms::index(block)];
+    return color::to_final_color(base_color, side);
   }
 
   // Each color has some set of plain-text chars representing block state. A
@@ -60,22 +159,18 @@ public:
   // them as chars.
   block::FinalBlock
   finalize_block(char block) const {
-    auto transformed = block - block_fixup_map_[block] + 1;
-    assert((transformed & ~vertex::BlockMask) == 0);
-    return block::FinalBlock{std::uint8_t(transformed)};
+    return transforms::finalize_block(block);
   };
 
   char
   unfinalize_block(block::FinalBlock block, color::FinalColor color) const {
-    return +block + color_to_char_unfixup_map_[+get_color(color)] - 1;
+    return transforms::unfinalize_block(block, color);
   }
 
   std::tuple<block::FinalBlock, color::FinalColor>
   do_transform(std::string_view vertex, RuleSide side) const {
     assert(vertex.size() > 0);
-    char              block             = vertex[0];
-    block::FinalBlock transformed_block = finalize_block(block);
-    return std::make_tuple(transformed_block, to_color(block, side));
+    return transforms::transform(*block_to_color_map_, vertex[0], side);
   }
 
   const_iterator
@@ -89,57 +184,45 @@ public:
   }
 
 private:
-  void
-  init_block_maps() {
-    for (auto & e : block_to_color_map_) {
-      e = Color::DEFAULT;
-    }
-    for (auto & e : block_fixup_map_) {
-      e = 'a'; // assume letters are the main units
-    }
-    for (auto & e : color_to_char_unfixup_map_) {
-      // solid rects, and customs, all use 'a' as base
-      e = 'a';
-    }
-
-    block_to_color_map_[block::NOTHING_BLOCK_CHAR] = Color::NOTHING;
-    block_fixup_map_[block::NOTHING_BLOCK_CHAR]    = '!';
-    color_to_char_unfixup_map_[+Color::NOTHING]    = '!';
-
-    block_to_color_map_['.']                     = Color::WILDCARD;
-    block_fixup_map_['.']                        = '.';
-    color_to_char_unfixup_map_[+Color::WILDCARD] = '.';
-
-    for (char c = '1'; c <= '9'; ++c) {
-      block_to_color_map_[c]                      = Color::BACKREF;
-      block_fixup_map_[c]                         = '1';
-      color_to_char_unfixup_map_[+Color::BACKREF] = '1';
+  // This Transforms' own block colors, copied from what it used before if it
+  // doesn't have them to itself yet. The defaults are held without an owner,
+  // so their use count is 0 and they are never written; a count of 1 can
+  // only be a copy made here.
+  BlockColorTable &
+  writable_block_colors() {
+    if (block_to_color_map_.use_count() != 1) {
+      block_to_color_map_ =
+          std::make_shared<BlockColorTable>(*block_to_color_map_);
     }
+    return const_cast<BlockColorTable &>(*block_to_color_map_);
   }
 
   Color
   get_or_create_color_by_name(std::string const & color_name) {
-    auto name_iter = std::find(begin(), end(), color_name);
-    auto offset    = std::distance(begin(), name_iter);
-    if (name_iter == end()) {
-      custom_color_names_.push_back(color_name);
+    auto found = custom_colors_.find(color_name);
+    if (found != custom_colors_.end()) {
+      return found->second;
+    }
+
+    auto offset = custom_color_names_.size();
+    if (+Color::NEXT_CUSTOM + offset >= vertex::MaxColors) {
+      throw std::runtime_error("Too many colors for vertex layout, adding: " +
+                               color_name);
     }
-    return Color(+Color::NEXT_CUSTOM + offset);
+    auto color = Color(+Color::NEXT_CUSTOM + offset);
+    custom_color_names_.push_back(color_name);
+    custom_colors_.emplace(color_name, color);
+    return color;
   }
 
 private:
-  // given a block (char) what is its color
-  Color block_to_color_map_[256];
-
-  // given a color, get the offset to convert a block back to a char to
-  // reverse a transform back to original char
-  char color_to_char_unfixup_map_[32]{};
-
-  // given a block (char) fixup (adj value to be 0-based by...)
-  char block_fixup_map_[256];
+  // the defaults, until there are overrides
+  std::shared_ptr<BlockColorTable const> block_to_color_map_{
+      std::shared_ptr<void>{}, &transforms::DefaultBlockColors};
 
   // for configuring runtime colors, like Cycle(abc), Cycle(ac), etc.
-  // The name is dynamically generated, unknown until it's seen.
-  ColorNames custom_color_names_;
-  Color      next_custom_color_ = Color::NEXT_CUSTOM;
+  // The name is dynamically generated, unknown until it's seen. Names are in
+  // the order their colors were made, with a hash to find each one's color.
+  ColorNames                             custom_color_names_;
+  std::unordered_map<std::string, Color> custom_colors_;
 };
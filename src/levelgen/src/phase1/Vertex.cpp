@@ -12,9 +12,9 @@ namespace vertex {
 using namespace std::literals;
 
 namespace {
-template <typename ColorPolicy>
+template <AnyVertex VertexT, typename ColorPolicy>
 std::string
-to_external_name(Vertex v, Transforms const & transforms,
+to_external_name(VertexT v, Transforms const & transforms,
                  ColorPolicy color_printer) {
   std::string       result = "[";
   color::FinalColor color  = get_final_color(v);
@@ -34,8 +34,9 @@ to_external_name(Vertex v, Transforms const & transforms,
 
 } // namespace
 
+template <AnyVertex VertexT>
 std::string
-to_string(Vertex vertex) {
+to_string(VertexT vertex) {
   std::string  blocks;
   char const * sep = "";
   for (block::FinalBlock block : get_blocks(vertex)) {
@@ -50,17 +51,26 @@ to_string(Vertex vertex) {
          to_string(get_final_color(vertex)) + ":" + blocks + ">";
 }
 
+template <AnyVertex VertexT>
 std::string
-to_external_short_name(Vertex v, Transforms const & transforms) {
+to_external_short_name(VertexT v, Transforms const & transforms) {
   return to_external_name(v, transforms, color::to_short_string);
 }
 
+template <AnyVertex VertexT>
 std::string
-to_external_name(Vertex v, Transforms const & transforms) {
+to_external_name(VertexT v, Transforms const & transforms) {
   return to_external_name(
       v,
       transforms,
       static_cast<std::string (*)(color::FinalColor)>(color::to_string));
 }
 
+template std::string to_string(Vertex32);
+template std::string to_string(Vertex64);
+template std::string to_external_name(Vertex32, Transforms const &);
+template std::string to_external_name(Vertex64, Transforms const &);
+template std::string to_external_short_name(Vertex32, Transforms const &);
+template std::string to_external_short_name(Vertex64, Transforms const &);
+
 } // namespace vertex
@@ -6,6 +6,7 @@
 
 #include <algorithm>
 #include <array>
+#include <cassert>
 #include <cstdint>
 #include <stdexcept>
 
@@ -17,6 +18,9 @@ namespace vertex {
 // It may hold 1 or more blocks (up to 6... AAAA-FFFF)
 // YYYY is the main color, while X is the From/To indicator
 // [??][S][YYYYX][AAAA][BBBB][CCCC][DDDD][EEEE][FFFF]
+//
+// That is Layout32. Layout64 is the same arrangement in a uint64_t, with 12
+// blocks and 8 color bits. The functions below work for either vertex type.
 
 // Blocks are all in terms of FinalBlock. This is a 0-based number assigned to
 // the current block, for its given color.  See Transforms.  Any 4-bit block of
@@ -32,153 +36,214 @@ namespace vertex {
 // from "aa->b, a->b" as in one, only the first 'a' has the start bit set, while
 // in the other, both 'a's do.
 
-enum class Vertex : std::uint32_t {};
+enum class Vertex32 : std::uint32_t {};
+enum class Vertex64 : std::uint64_t {};
+
+// The bit layout each vertex type is packed with (see VertexBitConstants.hpp)
+template <typename VertexT>
+struct LayoutOf {};
+
+template <>
+struct LayoutOf<Vertex32> {
+  using type = Layout32;
+};
+
+template <>
+struct LayoutOf<Vertex64> {
+  using type = Layout64;
+};
+
+template <typename VertexT>
+using layout_of = typename LayoutOf<VertexT>::type;
+
+template <typename VertexT>
+concept AnyVertex = requires { typename LayoutOf<VertexT>::type; };
+
+// The vertex the phase1 pipeline is built with. Configure with
+// LEVELGEN_WIDE_VERTICES for the 64-bit layout.
+#ifdef LEVELGEN_WIDE_VERTICES
+using Vertex = Vertex64;
+#else
+using Vertex = Vertex32;
+#endif
 
 // In a graph, this designates if this vertex is an entry point, the start of a
 // chain or internal (reachable only through other vertices)
 enum class VertexRole : bool { INTERNAL, START };
 
-std::string to_string(Vertex vertex);
-
-constexpr Vertex
-add_block(Vertex vertex, block::FinalBlock block) {
-  auto v     = +vertex;
-  auto shift = ((v >> Block1Shift) & BlockMask) == 0 ? Block1Shift
-             : ((v >> Block2Shift) & BlockMask) == 0 ? Block2Shift
-             : ((v >> Block3Shift) & BlockMask) == 0 ? Block3Shift
-             : ((v >> Block4Shift) & BlockMask) == 0 ? Block4Shift
-             : ((v >> Block5Shift) & BlockMask) == 0 ? Block5Shift
-             : ((v >> Block6Shift) & BlockMask) == 0
-                 ? Block6Shift
-                 : throw std::runtime_error("Vertex is Full");
-
-  return Vertex{v | (std::uint32_t(+block) << shift)};
+template <AnyVertex VertexT>
+std::string to_string(VertexT vertex);
+
+template <AnyVertex VertexT>
+constexpr VertexT
+add_block(VertexT vertex, block::FinalBlock block) {
+  using Layout = layout_of<VertexT>;
+  using Bits   = typename Layout::Bits;
+
+  auto v = +vertex;
+  for (int i = 0; i < Layout::MaxBlocksPerVertex; ++i) {
+    auto shift = Layout::block_shift(i);
+    if (((v >> shift) & Layout::BlockMask) == 0) {
+      return VertexT{v | (Bits(+block) << shift)};
+    }
+  }
+  throw std::runtime_error("Vertex is Full");
 }
 
-constexpr Vertex
-set_start_bit(Vertex vertex) {
-  return Vertex{+vertex | (1 << StartBitShift)};
+template <AnyVertex VertexT>
+constexpr VertexT
+set_start_bit(VertexT vertex) {
+  using Layout = layout_of<VertexT>;
+  return VertexT{+vertex | (typename Layout::Bits(1) << Layout::StartBitShift)};
 }
 
+template <AnyVertex VertexT>
 constexpr bool
-get_start_bit(Vertex vertex) {
-  return (+vertex >> StartBitShift) & 1;
+get_start_bit(VertexT vertex) {
+  return (+vertex >> layout_of<VertexT>::StartBitShift) & 1;
 }
 
 // "final_color" is normal color with the the From/To bit already set (or
 // unset) properly (see Color.h to finalize color)
 // "final_block" will be the first block added to this vertex.
-constexpr Vertex
+template <AnyVertex VertexT = Vertex>
+constexpr VertexT
 create(color::FinalColor final_color, block::FinalBlock block,
        VertexRole role) {
-  std::uint32_t value = +final_color << ColorShift;
-  Vertex        vertex{value};
+  using Layout = layout_of<VertexT>;
+  assert(+final_color <= Layout::ColorMask);
+  auto    value = typename Layout::Bits(+final_color) << Layout::ColorShift;
+  VertexT vertex{value};
   if (role == VertexRole::START) {
     vertex = set_start_bit(vertex);
   }
   return add_block(vertex, block);
 }
 
-constexpr Vertex
+template <AnyVertex VertexT = Vertex>
+constexpr VertexT
 create(color::FinalColor final_color, block::FinalBlock block1,
        block::FinalBlock block2, VertexRole role) {
-  return add_block(create(final_color, block1, role), block2);
+  return add_block(create<VertexT>(final_color, block1, role), block2);
 }
 
-constexpr Vertex
+template <AnyVertex VertexT = Vertex>
+constexpr VertexT
 create(color::FinalColor final_color, block::FinalBlock block1,
        block::FinalBlock block2, block::FinalBlock block3, VertexRole role) {
-  return add_block(create(final_color, block1, block2, role), block3);
+  return add_block(create<VertexT>(final_color, block1, block2, role), block3);
 }
 
-constexpr Vertex
+template <AnyVertex VertexT = Vertex>
+constexpr VertexT
 create(color::FinalColor final_color, block::FinalBlock block1,
        block::FinalBlock block2, block::FinalBlock block3,
        block::FinalBlock block4, VertexRole role) {
-  return add_block(create(final_color, block1, block2, block3, role), block4);
+  return add_block(
+      create<VertexT>(final_color, block1, block2, block3, role), block4);
 }
 
-constexpr Vertex
+template <AnyVertex VertexT = Vertex>
+constexpr VertexT
 create(color::FinalColor final_color, block::FinalBlock block1,
        block::FinalBlock block2, block::FinalBlock block3,
        block::FinalBlock block4, block::FinalBlock block5, VertexRole role) {
-  return add_block(create(final_color, block1, block2, block3, block4, role),
-                   block5);
+  return add_block(
+      create<VertexT>(final_color, block1, block2, block3, block4, role),
+      block5);
 }
 
-constexpr Vertex
+template <AnyVertex VertexT = Vertex>
+constexpr VertexT
 create(color::FinalColor final_color, block::FinalBlock block1,
        block::FinalBlock block2, block::FinalBlock block3,
        block::FinalBlock block4, block::FinalBlock block5,
        block::FinalBlock block6, VertexRole role) {
-  return add_block(
-      create(final_color, block1, block2, block3, block4, block5, role),
-      block6);
+  return add_block(create<VertexT>(final_color,
+                                   block1,
+                                   block2,
+                                   block3,
+                                   block4,
+                                   block5,
+                                   role),
+                   block6);
 }
 
+template <AnyVertex VertexT>
 constexpr color::FinalColor
-get_final_color(Vertex vertex) {
-  return color::FinalColor{std::uint8_t((+vertex >> ColorShift) & ColorMask)};
+get_final_color(VertexT vertex) {
+  using Layout = layout_of<VertexT>;
+  return color::FinalColor{
+      std::uint8_t((+vertex >> Layout::ColorShift) & Layout::ColorMask)};
 }
 
-constexpr Vertex
-set_final_color(Vertex vertex, color::FinalColor color) {
-  return Vertex{(+vertex & (~ColorMask << ColorShift)) |
-                (+color << ColorShift)};
+template <AnyVertex VertexT>
+constexpr VertexT
+set_final_color(VertexT vertex, color::FinalColor color) {
+  using Layout = layout_of<VertexT>;
+  using Bits   = typename Layout::Bits;
+  return VertexT{(+vertex & ~(Layout::ColorMask << Layout::ColorShift)) |
+                 (Bits(+color) << Layout::ColorShift)};
 }
 
+template <AnyVertex VertexT>
 constexpr block::FinalBlock
-get_block(Vertex vertex, std::uint8_t idx) {
-  auto bits = +vertex >> (Block1Shift - idx * BitsPerBlock);
-  return block::FinalBlock{std::uint8_t(bits & BlockMask)};
+get_block(VertexT vertex, std::uint8_t idx) {
+  using Layout = layout_of<VertexT>;
+  auto bits    = +vertex >> Layout::block_shift(idx);
+  return block::FinalBlock{std::uint8_t(bits & Layout::BlockMask)};
 }
 
-constexpr std::array<block::FinalBlock, MaxBlocksPerVertex>
-get_blocks(Vertex vertex) {
-  return {
-      block::FinalBlock((+vertex >> Block1Shift) & BlockMask),
-      block::FinalBlock((+vertex >> Block2Shift) & BlockMask),
-      block::FinalBlock((+vertex >> Block3Shift) & BlockMask),
-      block::FinalBlock((+vertex >> Block4Shift) & BlockMask),
-      block::FinalBlock((+vertex >> Block5Shift) & BlockMask),
-      block::FinalBlock((+vertex >> Block6Shift) & BlockMask),
-  };
+template <AnyVertex VertexT>
+constexpr std::array<block::FinalBlock, layout_of<VertexT>::MaxBlocksPerVertex>
+get_blocks(VertexT vertex) {
+  std::array<block::FinalBlock, layout_of<VertexT>::MaxBlocksPerVertex> blocks;
+  for (std::uint8_t i = 0; i < blocks.size(); ++i) {
+    blocks[i] = get_block(vertex, i);
+  }
+  return blocks;
 }
 
+template <AnyVertex VertexT>
 constexpr bool
-same_color(Vertex a, Vertex b) {
+same_color(VertexT a, VertexT b) {
   return get_final_color(a) == get_final_color(b);
 }
 
+template <AnyVertex VertexT>
 constexpr bool
-vertices_are_mergeable(Vertex a, Vertex b) {
+vertices_are_mergeable(VertexT a, VertexT b) {
   return is_mergeable(get_final_color(a), get_final_color(b)) &&
          get_start_bit(b) == false;
 }
 
+template <AnyVertex VertexT>
 constexpr bool
-is_full(Vertex vertex) {
+is_full(VertexT vertex) {
   // the "last" block is in the lowest bits.
-  return +vertex & BlockMask;
+  return +vertex & layout_of<VertexT>::BlockMask;
 }
 
+template <AnyVertex VertexT>
 constexpr int
-available_spaces(Vertex vertex) {
-  return (((+vertex >> Block1Shift) & BlockMask) == 0) +
-         (((+vertex >> Block2Shift) & BlockMask) == 0) +
-         (((+vertex >> Block3Shift) & BlockMask) == 0) +
-         (((+vertex >> Block4Shift) & BlockMask) == 0) +
-         (((+vertex >> Block5Shift) & BlockMask) == 0) +
-         (((+vertex >> Block6Shift) & BlockMask) == 0);
+available_spaces(VertexT vertex) {
+  using Layout = layout_of<VertexT>;
+  int spaces   = 0;
+  for (int i = 0; i < Layout::MaxBlocksPerVertex; ++i) {
+    spaces += ((+vertex >> Layout::block_shift(i)) & Layout::BlockMask) == 0;
+  }
+  return spaces;
 }
 
+template <AnyVertex VertexT>
 constexpr int
-size(Vertex vertex) {
-  return MaxBlocksPerVertex - available_spaces(vertex);
+size(VertexT vertex) {
+  return layout_of<VertexT>::MaxBlocksPerVertex - available_spaces(vertex);
 }
 
+template <AnyVertex VertexT>
 constexpr int
-num_can_merge(Vertex a, Vertex b) {
+num_can_merge(VertexT a, VertexT b) {
   // cannot merge a start bit vertex into another vertex, since the start bit
   // applies to the block at the front--after merging, the start info would not
   // be maintained.
@@ -189,31 +254,37 @@ num_can_merge(Vertex a, Vertex b) {
   return std::min(available_spaces(a), size(b));
 }
 
-constexpr Vertex
-pop_front(Vertex vertex, int num = 1) {
+template <AnyVertex VertexT>
+constexpr VertexT
+pop_front(VertexT vertex, int num = 1) {
   // as an abstract operation it's ok; but in context, we shouldn't pop from a
   // start vertex because that is only done during merging, and merging a start
   // into another vertex either loses the start bit or migrates it to the wrong
   // block at the front of the new vertex.
   assert(get_start_bit(vertex) == false);
 
-  auto highbits = +vertex & ~AllBlocksMask;
-  return Vertex{
-      (((+vertex & AllBlocksMask) << BitsPerBlock * num) & AllBlocksMask) |
-      highbits};
+  using Layout  = layout_of<VertexT>;
+  auto highbits = +vertex & ~Layout::AllBlocksMask;
+  auto blocks   = (+vertex & Layout::AllBlocksMask)
+              << Layout::BitsPerBlock * num;
+  return VertexT{(blocks & Layout::AllBlocksMask) | highbits};
 }
 
 // Take as many front blocks from b that fit into the available blocks of a.
-constexpr Vertex
-create_merged(Vertex a, Vertex b) {
+template <AnyVertex VertexT>
+constexpr VertexT
+create_merged(VertexT a, VertexT b) {
   assert(get_start_bit(b) == false); // see comment in pop_front
 
-  auto b_blockbits  = +b & AllBlocksMask; // remove color bits
-  auto shift_blocks = MaxBlocksPerVertex - available_spaces(a);
-  return Vertex{+a | (b_blockbits >> BitsPerBlock * shift_blocks)};
+  using Layout      = layout_of<VertexT>;
+  auto b_blockbits  = +b & Layout::AllBlocksMask; // remove color bits
+  auto shift_blocks = Layout::MaxBlocksPerVertex - available_spaces(a);
+  return VertexT{+a | (b_blockbits >> Layout::BitsPerBlock * shift_blocks)};
 }
 
-std::string to_external_name(Vertex v, Transforms const & transforms);
-std::string to_external_short_name(Vertex v, Transforms const & transforms);
+template <AnyVertex VertexT>
+std::string to_external_name(VertexT v, Transforms const & transforms);
+template <AnyVertex VertexT>
+std::string to_external_short_name(VertexT v, Transforms const & transforms);
 
 } // namespace vertex
@@ -0,0 +1,289 @@
+#include "VertexBatch.hpp"
+
+#include <algorithm>
+#include <cassert>
+#include <cstring>
+
+// The SIMD kernels are written for 32-bit vertices on x86-64, where SSE2 is
+// always there. The AVX2 ones are compiled for AVX2 function by function, so
+// the rest of this file (and the inline code it includes) stays baseline, and
+// they are only called after checking the CPU running them has it.
+#if defined(__x86_64__) && defined(__GNUC__) && \
+    not defined(LEVELGEN_WIDE_VERTICES)
+#define VERTEX_BATCH_X86
+#define VERTEX_BATCH_AVX2_TARGET __attribute__((target("avx2")))
+#include <immintrin.h>
+#endif
+
+namespace vertex::batch {
+
+namespace scalar {
+
+void
+sizes(VertexSpan in, ByteSpan out) {
+  assert(out.size() >= in.size());
+  for (std::size_t i = 0; i < in.size(); ++i) {
+    out[i] = size(in[i]);
+  }
+}
+
+void
+final_colors(VertexSpan in, ByteSpan out) {
+  assert(out.size() >= in.size());
+  for (std::size_t i = 0; i < in.size(); ++i) {
+    out[i] = +get_final_color(in[i]);
+  }
+}
+
+void
+start_bits(VertexSpan in, ByteSpan out) {
+  assert(out.size() >= in.size());
+  for (std::size_t i = 0; i < in.size(); ++i) {
+    out[i] = get_start_bit(in[i]);
+  }
+}
+
+void
+color_mask(VertexSpan in, color::FinalColor color, ByteSpan out) {
+  assert(out.size() >= in.size());
+  for (std::size_t i = 0; i < in.size(); ++i) {
+    out[i] = get_final_color(in[i]) == color;
+  }
+}
+
+} // namespace scalar
+
+namespace {
+
+enum class Kernels { Scalar, Sse2, Avx2 };
+
+Kernels
+detect_kernels() {
+#if defined(VERTEX_BATCH_X86)
+  __builtin_cpu_init();
+  return __builtin_cpu_supports("avx2") ? Kernels::Avx2 : Kernels::Sse2;
+#else
+  return Kernels::Scalar;
+#endif
+}
+
+Kernels
+kernels() {
+  static Kernels const best = detect_kernels();
+  return best;
+}
+
+enum class Field { Size, Color, StartBit, ColorMatch };
+
+#if defined(VERTEX_BATCH_X86)
+
+// One vertex per 32-bit lane, as GCC vector extensions, so that to_field
+// compiles to SSE2 or AVX2 instructions depending on the kernel it is inlined
+// into. Lanes are only passed by reference: passing a 256-bit vector by value
+// outside AVX2 code has its own ABI. A step is four registers' worth of
+// vertices, packed down to one byte each.
+using Lanes128 = std::uint32_t __attribute__((vector_size(16)));
+using Lanes256 = std::uint32_t __attribute__((vector_size(32)));
+
+// Replaces each vertex with the field asked for. Blocks fill a vertex from
+// the front, and an unused block is 0, so the size is the number of nonzero
+// 4-bit blocks: fold each block's bits into its lowest bit, then sum those
+// six bits into the bottom nibble.
+template <Field FieldV, typename LanesT>
+[[gnu::always_inline]] inline void
+to_field(LanesT & lanes, std::uint32_t color) {
+  if constexpr (FieldV == Field::Size) {
+    LanesT blocks = lanes & AllBlocksMask;
+    LanesT ones   = (blocks | blocks >> 1 | blocks >> 2 | blocks >> 3) &
+                  0x111111;
+    ones += ones >> 4;
+    ones += ones >> 8;
+    ones += ones >> 16;
+    lanes = ones & BlockMask;
+  }
+  else if constexpr (FieldV == Field::Color) {
+    lanes = lanes >> ColorShift & ColorMask;
+  }
+  else if constexpr (FieldV == Field::StartBit) {
+    lanes = lanes >> StartBitShift & 1;
+  }
+  else {
+    // a true comparison is all ones
+    lanes = LanesT((lanes >> ColorShift & ColorMask) == color) & 1;
+  }
+}
+
+template <Field FieldV, typename LanesT>
+[[gnu::always_inline]] inline void
+load_fields(Vertex const * in, std::uint32_t color, LanesT & a, LanesT & b,
+            LanesT & c, LanesT & d) {
+  static_assert(sizeof(Vertex) == sizeof(std::uint32_t));
+  constexpr std::size_t Lanes = sizeof(LanesT) / sizeof(Vertex);
+  std::memcpy(&a, in, sizeof a);
+  std::memcpy(&b, in + Lanes, sizeof b);
+  std::memcpy(&c, in + 2 * Lanes, sizeof c);
+  std::memcpy(&d, in + 3 * Lanes, sizeof d);
+  to_field<FieldV>(a, color);
+  to_field<FieldV>(b, color);
+  to_field<FieldV>(c, color);
+  to_field<FieldV>(d, color);
+}
+
+// Each runs whole steps of 16 (or 32) vertices, and returns how many vertices
+// they covered.
+template <Field FieldV>
+std::size_t
+run_sse2(VertexSpan in, ByteSpan out, std::uint32_t color) {
+  constexpr std::size_t VerticesPerStep = 16;
+
+  std::size_t done = 0;
+  for (; done + VerticesPerStep <= in.size(); done += VerticesPerStep) {
+    Lanes128 a, b, c, d;
+    load_fields<FieldV>(in.data() + done, color, a, b, c, d);
+    auto bytes = _mm_packus_epi16(_mm_packs_epi32(__m128i(a), __m128i(b)),
+                                  _mm_packs_epi32(__m128i(c), __m128i(d)));
+    _mm_storeu_si128(reinterpret_cast<__m128i *>(out.data() + done), bytes);
+  }
+  return done;
+}
+
+template <Field FieldV>
+VERTEX_BATCH_AVX2_TARGET std::size_t
+run_avx2(VertexSpan in, ByteSpan out, std::uint32_t color) {
+  constexpr std::size_t VerticesPerStep = 32;
+
+  std::size_t done = 0;
+  for (; done + VerticesPerStep <= in.size(); done += VerticesPerStep) {
+    Lanes256 a, b, c, d;
+    load_fields<FieldV>(in.data() + done, color, a, b, c, d);
+
+    // packing works within each 128-bit half, so dwords come out in the order
+    // a0 b0 c0 d0 a1 b1 c1 d1 and need putting back in sequence.
+    auto bytes =
+        _mm256_packus_epi16(_mm256_packs_epi32(__m256i(a), __m256i(b)),
+                            _mm256_packs_epi32(__m256i(c), __m256i(d)));
+    auto order = _mm256_setr_epi32(0, 4, 1, 5, 2, 6, 3, 7);
+    bytes      = _mm256_permutevar8x32_epi32(bytes, order);
+    _mm256_storeu_si256(reinterpret_cast<__m256i *>(out.data() + done),
+                        bytes);
+  }
+  return done;
+}
+
+#endif
+
+// runs the best kernels for this CPU over whole steps, returns how many
+// vertices they covered, leaving the rest for the scalar version
+template <Field FieldV>
+std::size_t
+run_best(VertexSpan in, ByteSpan out, std::uint32_t color = 0) {
+  assert(out.size() >= in.size());
+  switch (kernels()) {
+#if defined(VERTEX_BATCH_X86)
+  case Kernels::Avx2:
+    return run_avx2<FieldV>(in, out, color);
+  case Kernels::Sse2:
+    return run_sse2<FieldV>(in, out, color);
+#endif
+  default:
+    return 0;
+  }
+}
+
+constexpr std::size_t ChunkSize = 256;
+
+using Chunk = std::array<std::uint8_t, ChunkSize>;
+
+// calls back with equal-length chunks of a and b, until it returns false
+template <typename CallbackT>
+bool
+all_chunks(VertexSpan a, VertexSpan b, CallbackT cb) {
+  assert(a.size() == b.size());
+  for (std::size_t from = 0; from < a.size(); from += ChunkSize) {
+    auto const len = std::min(ChunkSize, a.size() - from);
+    if (not cb(a.subspan(from, len), b.subspan(from, len))) {
+      return false;
+    }
+  }
+  return true;
+}
+
+} // namespace
+
+char const *
+implementation() {
+  switch (kernels()) {
+  case Kernels::Avx2:
+    return "avx2";
+  case Kernels::Sse2:
+    return "sse2";
+  default:
+    return "scalar";
+  }
+}
+
+void
+sizes(VertexSpan in, ByteSpan out) {
+  auto done = run_best<Field::Size>(in, out);
+  scalar::sizes(in.subspan(done), out.subspan(done));
+}
+
+void
+final_colors(VertexSpan in, ByteSpan out) {
+  auto done = run_best<Field::Color>(in, out);
+  scalar::final_colors(in.subspan(done), out.subspan(done));
+}
+
+void
+start_bits(VertexSpan in, ByteSpan out) {
+  auto done = run_best<Field::StartBit>(in, out);
+  scalar::start_bits(in.subspan(done), out.subspan(done));
+}
+
+void
+color_mask(VertexSpan in, color::FinalColor color, ByteSpan out) {
+  auto done = run_best<Field::ColorMatch>(in, out, +color);
+  scalar::color_mask(in.subspan(done), color, out.subspan(done));
+}
+
+SizeHistogram
+size_histogram(VertexSpan in) {
+  SizeHistogram histogram{};
+  Chunk         chunk_sizes;
+  while (not in.empty()) {
+    auto chunk = in.first(std::min(ChunkSize, in.size()));
+    sizes(chunk, chunk_sizes);
+    for (std::size_t i = 0; i < chunk.size(); ++i) {
+      ++histogram[chunk_sizes[i]];
+    }
+    in = in.subspan(chunk.size());
+  }
+  return histogram;
+}
+
+bool
+same_colors(VertexSpan a, VertexSpan b) {
+  return all_chunks(a, b, [](VertexSpan a_chunk, VertexSpan b_chunk) {
+    Chunk a_colors, b_colors;
+    final_colors(a_chunk, a_colors);
+    final_colors(b_chunk, b_colors);
+    return std::memcmp(a_colors.data(), b_colors.data(), a_chunk.size()) == 0;
+  });
+}
+
+bool
+same_shapes(VertexSpan a, VertexSpan b) {
+  return all_chunks(a, b, [](VertexSpan a_chunk, VertexSpan b_chunk) {
+    Chunk a_fields, b_fields;
+    start_bits(a_chunk, a_fields);
+    start_bits(b_chunk, b_fields);
+    if (std::memcmp(a_fields.data(), b_fields.data(), a_chunk.size()) != 0) {
+      return false;
+    }
+    sizes(a_chunk, a_fields);
+    sizes(b_chunk, b_fields);
+    return std::memcmp(a_fields.data(), b_fields.data(), a_chunk.size()) == 0;
+  });
+}
+
+} // namespace vertex::batch
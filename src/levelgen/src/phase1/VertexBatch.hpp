@@ -0,0 +1,57 @@
+#pragma once
+
+#include "Color.hpp"
+#include "Vertex.hpp"
+#include "VertexBitConstants.hpp"
+
+#include <array>
+#include <cstdint>
+#include <span>
+
+// Batch versions of the per-vertex field accessors in Vertex.hpp, over whole
+// arrays of vertices at once. Each writes one byte per input vertex, and out
+// must be at least as long as in. On x86-64 these handle 16 vertices per step
+// with SSE2, or 32 with AVX2 if the CPU running them has it; elsewhere (and
+// always for the 64-bit layout) they fall back to the scalar functions.
+// Results are identical either way.
+
+namespace vertex::batch {
+
+using VertexSpan = std::span<Vertex const>;
+using ByteSpan   = std::span<std::uint8_t>;
+
+// how many vertices have each number of blocks, 0 through MaxBlocksPerVertex
+using SizeHistogram = std::array<int, MaxBlocksPerVertex + 1>;
+
+// name of the kernels in use: "avx2", "sse2" or "scalar"
+char const * implementation();
+
+// out[i] = size(in[i])
+void sizes(VertexSpan in, ByteSpan out);
+
+// out[i] = +get_final_color(in[i])
+void final_colors(VertexSpan in, ByteSpan out);
+
+// out[i] = get_start_bit(in[i])
+void start_bits(VertexSpan in, ByteSpan out);
+
+// out[i] = get_final_color(in[i]) == color
+void color_mask(VertexSpan in, color::FinalColor color, ByteSpan out);
+
+SizeHistogram size_histogram(VertexSpan in);
+
+// Compare a[i] with b[i] for every i; a and b must be the same length.
+// same_shapes is the part of isomorphism::check_blocks that needs no block
+// map: equal start bits and sizes.
+bool same_colors(VertexSpan a, VertexSpan b);
+bool same_shapes(VertexSpan a, VertexSpan b);
+
+// The scalar versions, always available; for testing and benchmarking
+namespace scalar {
+void sizes(VertexSpan in, ByteSpan out);
+void final_colors(VertexSpan in, ByteSpan out);
+void start_bits(VertexSpan in, ByteSpan out);
+void color_mask(VertexSpan in, color::FinalColor color, ByteSpan out);
+} // namespace scalar
+
+} // namespace vertex::batch
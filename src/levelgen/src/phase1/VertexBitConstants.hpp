@@ -4,21 +4,63 @@
 
 namespace vertex {
 
-// bit shifting for internal fields
-static constexpr std::uint32_t StartBitShift      = 29;
-static constexpr std::uint32_t ColorShift         = 24;
-static constexpr std::uint32_t Block1Shift        = 20;
-static constexpr std::uint32_t Block2Shift        = 16;
-static constexpr std::uint32_t Block3Shift        = 12;
-static constexpr std::uint32_t Block4Shift        = 8;
-static constexpr std::uint32_t Block5Shift        = 4;
-static constexpr std::uint32_t Block6Shift        = 0;
-static constexpr std::uint32_t MaxBlocksPerVertex = 6;
-static constexpr std::uint32_t BitsPerBlock       = 4;
-static constexpr std::uint32_t BlockMask          = (1 << BitsPerBlock) - 1;
-static constexpr std::uint32_t BitsForColor       = 5;
-static constexpr std::uint32_t ColorMask          = (1 << BitsForColor) - 1;
-static constexpr std::uint32_t AllBlocksMask =
-    (1 << MaxBlocksPerVertex * BitsPerBlock) - 1;
+// How a vertex packs into an unsigned integer, from the high bits down:
+// [unused][S][color][block 1]...[block N]
+// Every vertex function is written against one of these, so the same code
+// serves either width.
+template <typename BitsT, int BlockBits, int MaxBlocks, int ColorBits>
+struct BitLayout {
+  using Bits = BitsT;
+
+  static constexpr int  MaxBlocksPerVertex = MaxBlocks;
+  static constexpr Bits BitsPerBlock       = BlockBits;
+  static constexpr Bits BitsForColor       = ColorBits;
+
+  // bit shifting for internal fields
+  static constexpr Bits ColorShift    = MaxBlocks * BlockBits;
+  static constexpr Bits StartBitShift = ColorShift + ColorBits;
+
+  static constexpr Bits BlockMask     = (Bits(1) << BlockBits) - 1;
+  static constexpr Bits ColorMask     = (Bits(1) << ColorBits) - 1;
+  static constexpr Bits AllBlocksMask = (Bits(1) << ColorShift) - 1;
+
+  // number of distinct Colors, as the low color bit is the rule side
+  static constexpr int MaxColors = 1 << (ColorBits - 1);
+
+  // block 0 is the front of the chain, in the highest block bits
+  static constexpr Bits
+  block_shift(int idx) {
+    return (MaxBlocks - 1 - idx) * BlockBits;
+  }
+
+  static_assert(StartBitShift < sizeof(Bits) * 8);
+};
+
+// 6 blocks and 16 colors in 32 bits, the long-standing default
+using Layout32 = BitLayout<std::uint32_t, 4, 6, 5>;
+
+// 12 blocks and 128 colors in 64 bits, for levels with long same-color runs
+// or many custom colors.
+using Layout64 = BitLayout<std::uint64_t, 4, 12, 8>;
+
+#ifdef LEVELGEN_WIDE_VERTICES
+using DefaultLayout = Layout64;
+#else
+using DefaultLayout = Layout32;
+#endif
+
+// the default layout's fields, for code that only deals in vertex::Vertex
+using Bits = DefaultLayout::Bits;
+
+static constexpr Bits StartBitShift      = DefaultLayout::StartBitShift;
+static constexpr Bits ColorShift         = DefaultLayout::ColorShift;
+static constexpr Bits Block1Shift        = DefaultLayout::block_shift(0);
+static constexpr Bits MaxBlocksPerVertex = DefaultLayout::MaxBlocksPerVertex;
+static constexpr Bits BitsPerBlock       = DefaultLayout::BitsPerBlock;
+static constexpr Bits BlockMask          = DefaultLayout::BlockMask;
+static constexpr Bits BitsForColor       = DefaultLayout::BitsForColor;
+static constexpr Bits ColorMask          = DefaultLayout::ColorMask;
+static constexpr Bits AllBlocksMask      = DefaultLayout::AllBlocksMask;
+static constexpr int  MaxColors          = DefaultLayout::MaxColors;
 
 } // namespace vertex
@@ -2,13 +2,17 @@
 
 #include "Block.hpp"
 #include "RuleSide.hpp"
+#include "RunMerge.hpp"
+#include "hash_utils.hpp"
 #include "sort.hpp"
 
 #include <algorithm>
 #include <cassert>
+#include <functional>
 #include <numeric>
 #include <stdexcept>
 #include <string_view>
+#include <utility>
 
 /*
 memory layout
@@ -21,12 +25,12 @@ to grou them.
 [AAAA]...[FFFF] each group A..F is 4 bits each per block of same color.
 
 Nodes like the above represent a single vertex. Adjacent blocks
-can be combined into a single node if they fit, or chained
-through multiple vertexes. While not expected to happen, if we
-had a sequence of more than 6 blocks of the same color, they
-wouldn't all fit in the above memory scheme, but we could have
-additional 32-bit memory structures chained in the graph,
-as needed.
+can be combined into a single node if they fit. While not expected
+to happen often, a sequence of more than 6 blocks of the same color
+won't all fit in the above memory scheme, so the rest go in
+continuation records of the same layout, chained to the vertex
+outside of the graph (see continuation_of), and the run is still
+a single vertex.
 
 The ENTIRE chain from a node to the end is considered its
 identity. For building the graph, for example, we cannot take a
@@ -100,64 +104,182 @@ because while we are reading in the graph it's too early to merge.  We do not
 
 */
 
-Vertices::Vertices() {
-  vertex_names_.reserve(DefaultCapacity);
+Vertices::Vertices(std::pmr::memory_resource * resource)
+    : name_arena_(resource),
+      name_refs_(resource),
+      vertices_(resource),
+      colors_(resource),
+      start_bits_(resource),
+      block_counts_(resource),
+      continuations_(resource),
+      name_slots_(DefaultCapacity * 2, EmptySlot, resource) {
+  name_arena_.reserve(DefaultArenaCapacity);
+  name_refs_.reserve(DefaultCapacity);
   vertices_.reserve(DefaultCapacity);
+  colors_.reserve(DefaultCapacity);
+  start_bits_.reserve(DefaultCapacity);
+  block_counts_.reserve(DefaultCapacity);
+  continuations_.reserve(DefaultCapacity);
 }
 
-Vertices::size_type
-Vertices::size() const {
-  return std::size(vertex_names_);
+Vertices::NamePrefix
+Vertices::name_prefix(color::FinalColor final_color) {
+  return {has_from(final_color) ? 'F' : 'T',
+          color_as_char(get_color(final_color))};
 }
 
-Vertices::size_type
-Vertices::names_size() const {
-  return std::size(vertex_names_);
+std::size_t
+Vertices::hash_name(NamePrefix prefix, std::string_view suffix) {
+  auto prefix_bits = std::size_t(prefix[0]) << 8 | std::size_t(prefix[1]);
+  return hashing::combine(prefix_bits, std::hash<std::string_view>{}(suffix));
+}
+
+std::size_t
+Vertices::hash_of(int idx) const {
+  return hash_name(prefix_of(idx), suffix_of(idx));
+}
+
+bool
+Vertices::name_equals(int idx, NamePrefix prefix,
+                      std::string_view suffix) const {
+  return prefix_of(idx) == prefix && suffix_of(idx) == suffix;
+}
+
+// Returns the slot holding the given name, or the empty slot where it would
+// be inserted.
+std::size_t
+Vertices::slot_of(NamePrefix prefix, std::string_view suffix) const {
+  auto const mask = name_slots_.size() - 1;
+  auto       slot = hash_name(prefix, suffix) & mask;
+  while (name_slots_[slot] != EmptySlot &&
+         not name_equals(name_slots_[slot], prefix, suffix)) {
+    slot = (slot + 1) & mask;
+  }
+  return slot;
 }
 
-Vertices::iterator
-Vertices::names_begin() {
-  return std::begin(vertex_names_);
+std::size_t
+Vertices::slot_of(int idx) const {
+  return slot_of(prefix_of(idx), suffix_of(idx));
 }
 
-Vertices::iterator
-Vertices::names_end() {
-  return std::end(vertex_names_);
+void
+Vertices::index_name(int idx) {
+  if (name_slots_.empty()) {
+    return; // dropped; rebuilt on the next lookup
+  }
+  if (name_refs_.size() * 2 > name_slots_.size()) {
+    rehash(name_slots_.size() * 2); // indexes every name, including idx
+    return;
+  }
+  auto slot = slot_of(idx);
+  assert(name_slots_[slot] == EmptySlot);
+  name_slots_[slot] = idx;
+}
+
+// Backward-shift deletion: entries after the hole that would no longer be
+// reachable from their home slot are moved up into it, so no tombstones are
+// needed.
+void
+Vertices::unindex_name(int idx) {
+  if (name_slots_.empty()) {
+    return;
+  }
+  auto const mask = name_slots_.size() - 1;
+  auto       hole = slot_of(idx);
+  assert(name_slots_[hole] == idx);
+  name_slots_[hole] = EmptySlot;
+
+  for (auto slot = (hole + 1) & mask; name_slots_[slot] != EmptySlot;
+       slot      = (slot + 1) & mask) {
+    auto home = hash_of(name_slots_[slot]) & mask;
+    // move it if its home is not cyclically within (hole, slot]
+    if (((slot - home) & mask) >= ((slot - hole) & mask)) {
+      name_slots_[hole] = std::exchange(name_slots_[slot], EmptySlot);
+      hole              = slot;
+    }
+  }
+}
+
+// the name at old_idx is about to move to new_idx
+void
+Vertices::reindex_name(int old_idx, int new_idx) {
+  if (name_slots_.empty()) {
+    return;
+  }
+  auto slot = slot_of(old_idx);
+  assert(name_slots_[slot] == old_idx);
+  name_slots_[slot] = new_idx;
+}
+
+void
+Vertices::rehash(std::size_t num_slots) const {
+  name_slots_.assign(num_slots, EmptySlot);
+  for (int idx = 0, sz = name_refs_.size(); idx < sz; ++idx) {
+    name_slots_[slot_of(idx)] = idx;
+  }
+}
+
+void
+Vertices::ensure_name_index() const {
+  if (not name_slots_.empty()) {
+    return;
+  }
+  std::size_t num_slots = DefaultCapacity * 2;
+  while (num_slots < name_refs_.size() * 4) {
+    num_slots *= 2;
+  }
+  rehash(num_slots);
+}
+
+Vertices::size_type
+Vertices::size() const {
+  return std::size(name_refs_);
+}
+
+Vertices::size_type
+Vertices::names_size() const {
+  return std::size(name_refs_);
 }
 
 Vertices::const_iterator
 Vertices::names_begin() const {
-  return std::begin(vertex_names_);
+  return {this, 0};
 }
 
 Vertices::const_iterator
 Vertices::names_end() const {
-  return std::end(vertex_names_);
+  return {this, int(name_refs_.size())};
+}
+
+int
+Vertices::find_name(NamePrefix prefix, std::string_view suffix) const {
+  ensure_name_index();
+  return name_slots_[slot_of(prefix, suffix)];
 }
 
 int
 Vertices::name_index_of(std::string_view  vertex_name,
                         color::FinalColor final_color) const {
-  auto internal_vertex_name = internal_name(vertex_name, final_color);
-  return index_of_internal_name(internal_vertex_name);
+  return find_name(name_prefix(final_color), vertex_name);
 }
 
 int
 Vertices::index_of_internal_name(std::string_view internal_vertex_name) const {
-  auto it = std::find(names_begin(), names_end(), internal_vertex_name);
-  if (it == names_end()) {
+  if (internal_vertex_name.size() < 2) {
     return -1;
   }
-  return it - names_begin();
+  return find_name({internal_vertex_name[0], internal_vertex_name[1]},
+                   internal_vertex_name.substr(2));
 }
 
 int
 Vertices::name_index_of_checked(std::string_view  vertex_name,
                                 color::FinalColor final_color) const {
-  auto internal_vertex_name = internal_name(vertex_name, final_color);
-  int  idx = index_of_checked_internal_name(internal_vertex_name);
+  int idx = name_index_of(vertex_name, final_color);
   if (idx == -1) {
-    throw std::runtime_error("vertex " + internal_vertex_name + " unknown");
+    throw std::runtime_error(
+        "vertex " + internal_name(vertex_name, final_color) + " unknown");
   }
   return idx;
 }
@@ -173,24 +295,74 @@ Vertices::index_of_checked_internal_name(
   return idx;
 }
 
-std::string const &
+std::string
 Vertices::name_of(int index) const {
-  return vertex_names_[index];
+  auto        prefix = prefix_of(index);
+  auto        suffix = suffix_of(index);
+  std::string name;
+  name.reserve(prefix.size() + suffix.size());
+  name.append(prefix.data(), prefix.size());
+  name.append(suffix);
+  return name;
+}
+
+Vertices::NamePrefix
+Vertices::prefix_of(int index) const {
+  return name_refs_[index].prefix;
+}
+
+std::string_view
+Vertices::suffix_of(int index) const {
+  auto ref = name_refs_[index];
+  return std::string_view(name_arena_).substr(ref.offset, ref.length);
 }
 
 bool
 Vertices::compatible_number_and_colors(Vertices const & other) const {
-  auto const sz = vertices_.size();
-  if (sz != other.vertices_.size()) {
-    return false;
+  return colors_ == other.colors_;
+}
+
+void
+Vertices::push_vertex(vertex::Vertex v) {
+  vertices_.push_back(v);
+  colors_.push_back(+get_final_color(v));
+  start_bits_.push_back(get_start_bit(v));
+  block_counts_.push_back(vertex::size(v));
+  continuations_.emplace_back();
+}
+
+int
+Vertices::run_size(int idx) const {
+  int total = block_counts_[idx];
+  for (auto record : continuations_[idx]) {
+    total += vertex::size(record);
   }
+  return total;
+}
 
-  for (int i = 0; i < sz; ++i) {
-    if (get_final_color(vertices_[i]) != get_final_color(other.vertices_[i])) {
-      return false;
-    }
+void
+Vertices::append_run(int into_idx, int from_idx) {
+  assert(into_idx != from_idx);
+  assert(vertex::vertices_are_mergeable(vertices_[into_idx],
+                                        vertices_[from_idx]));
+
+  auto   head = vertices_[into_idx];
+  auto & rest = continuations_[into_idx];
+  run_merge::append_blocks(head, rest, vertices_[from_idx]);
+  for (auto record : continuations_[from_idx]) {
+    run_merge::append_blocks(head, rest, record);
   }
-  return true;
+  set_vertex(into_idx, head);
+
+  auto emptied = vertex::pop_front(vertices_[from_idx],
+                                   vertex::MaxBlocksPerVertex);
+  set_vertex(from_idx, emptied);
+  continuations_[from_idx].clear();
+}
+
+void
+Vertices::set_continuation(int idx, VertexSpan records) {
+  continuations_[idx].assign(records.begin(), records.end());
 }
 
 int
@@ -198,29 +370,51 @@ Vertices::add_vertex_single(std::string_view   vertex_name,
                             block::FinalBlock  transformed_block,
                             color::FinalColor  final_color,
                             vertex::VertexRole role) {
-  auto internal_vertex_name = internal_name(vertex_name, final_color);
-  int  idx                  = index_of_internal_name(internal_vertex_name);
+  auto prefix = name_prefix(final_color);
+  int  idx    = find_name(prefix, vertex_name);
 
   if (idx == -1) {
     idx = names_size();
-    vertex_names_.emplace_back(internal_vertex_name);
-    vertices_.push_back(vertex::create(final_color, transformed_block, role));
+    name_refs_.push_back({add_name_text(vertex_name),
+                          std::uint32_t(vertex_name.size()),
+                          prefix});
+    push_vertex(vertex::create(final_color, transformed_block, role));
+    index_name(idx);
   }
   else if (role == vertex::VertexRole::START &&
            get_start_bit(vertices_[idx]) == false) {
-    vertices_[idx] = set_start_bit(vertices_[idx]);
+    set_vertex(idx, set_start_bit(vertices_[idx]));
   }
   return idx;
 }
 
+std::uint32_t
+Vertices::add_name_text(std::string_view text) {
+  auto offset = std::uint32_t(name_arena_.size());
+  name_arena_.append(text);
+  return offset;
+}
+
+int
+Vertices::append_vertex(std::uint32_t name_offset, std::uint32_t name_length,
+                        block::FinalBlock  transformed_block,
+                        color::FinalColor  final_color,
+                        vertex::VertexRole role) {
+  assert(name_offset + name_length <= name_arena_.size());
+  int idx = names_size();
+  name_refs_.push_back({name_offset, name_length, name_prefix(final_color)});
+  push_vertex(vertex::create(final_color, transformed_block, role));
+  name_slots_.clear();
+  return idx;
+}
+
 std::string
 Vertices::pretty_name(int idx) const {
-  using ::vertex::size;
-
-  auto vertex = vertices_.at(idx);
-  auto name   = vertex_names_[idx];
-  if (size(name) > size(vertex) + 2) {
-    name.insert(size(vertex) + 2, 1, ':');
+  auto        vertex = vertices_.at(idx);
+  std::string name   = name_of(idx);
+  auto        blocks = run_size(idx);
+  if (std::ssize(name) > blocks + 2) {
+    name.insert(blocks + 2, 1, ':');
   }
   return (get_start_bit(vertex) ? '^' : ' ') + name;
 }
@@ -229,68 +423,97 @@ std::string
 Vertices::internal_name(std::string_view  vertex_id_string,
                         color::FinalColor final_color) {
   // convert color to printable char and prefix the name with it.
-  return to_short_string(final_color) + std::string(vertex_id_string);
+  auto prefix = name_prefix(final_color);
+  return std::string(prefix.data(), prefix.size()) +
+         std::string(vertex_id_string);
 }
 
+// The removed name's characters stay in the arena until the Vertices object
+// goes away; only its reference is dropped.
 int
 Vertices::remove_vertex(int idx) {
-  if (vertex_names_.empty()) {
+  if (name_refs_.empty()) {
     return -1;
   }
 
-  int last_idx = vertex_names_.size() - 1;
+  int last_idx = name_refs_.size() - 1;
+  unindex_name(idx);
   if (last_idx != idx) {
-    vertex_names_[idx] = vertex_names_[last_idx];
-    vertices_[idx]     = vertices_[last_idx];
+    reindex_name(last_idx, idx);
+    name_refs_[idx] = name_refs_[last_idx];
+    set_vertex(idx, vertices_[last_idx]);
+    continuations_[idx] = std::move(continuations_[last_idx]);
   }
-  vertex_names_.pop_back();
+  name_refs_.pop_back();
   vertices_.pop_back();
+  colors_.pop_back();
+  start_bits_.pop_back();
+  block_counts_.pop_back();
+  continuations_.pop_back();
 
   return last_idx;
 }
 
 // first sort by color, then start-bit, then num blocks in vertex, then numeric
-// value of vertex
-static auto vertex_compare = [](vertex::Vertex v1, vertex::Vertex v2) {
-  auto color_diff = +get_final_color(v1) - +get_final_color(v2);
-  if (color_diff != 0) {
-    return color_diff < 0;
-  }
-
-  auto start_diff = get_start_bit(v1) - get_start_bit(v2);
-  if (start_diff != 0) {
-    return start_diff < 0;
-  }
-
-  auto size_diff = size(v1) - size(v2);
-  if (size_diff != 0) {
-    return size_diff < 0;
-  }
-
-  return +v1 < +v2;
-};
-
-std::vector<int>
+// value of vertex (see sort_key), with the vertex index in the low bits of the
+// key to recover the permutation and break ties. The 64-bit layout's keys
+// leave no room for the index, so there it is kept alongside instead and
+// sorted with std::sort.
+static constexpr int  IndexBits      = 31;
+static constexpr bool IndexFitsInKey = Vertices::SortKeyBits + IndexBits <= 64;
+
+Vertices::IndexVec
 Vertices::compute_sorted_index_map() {
   // Enables a simultaneous sort of 2 vectors, so sort the *indices* instead of
   // elements. This initially sorts it such that each element e (an index) is in
-  // the location of where vertex_names_[e] should go. If a->bc then we may and
+  // the location of where name e should go. If a->bc then we may and
   // up with [b, c, a] with corresponding index array [1, 2, 0]. In that case it
   // means "take element 1, then 2, then 0".
   // But the swapping algorithm wants the mapping reversed. Instead of "take 1,
   // then 2, then 0" it must be represented as "put a in slot 2, b in slot 0, c
   // in slot 1". Reversing the index and mapped value solves this:
-  std::vector<int> idx(vertex_names_.size());
-  std::iota(begin(idx), end(idx), 0); // populate w/ initial indices
-  std::sort(begin(idx), end(idx), [this](auto idx1, auto idx2) {
-    return vertex_compare(vertices_[idx1], vertices_[idx2]);
-  });
+  int const sz = vertices_.size();
+  IndexVec  idx(sz, resource());
+  if constexpr (IndexFitsInKey) {
+    std::pmr::vector<std::uint64_t> keys(sz, resource());
+    for (int i = 0; i < sz; ++i) {
+      keys[i] = sort_key(vertices_[i]) << IndexBits | i;
+    }
+    algo::radix_sort(keys);
+
+    constexpr std::uint64_t IndexMask = (std::uint64_t(1) << IndexBits) - 1;
+    for (int i = 0; i < sz; ++i) {
+      idx[i] = keys[i] & IndexMask;
+    }
+  }
+  else {
+    std::pmr::vector<std::pair<std::uint64_t, int>> keys(sz, resource());
+    for (int i = 0; i < sz; ++i) {
+      keys[i] = {sort_key(vertices_[i]), i};
+    }
+    std::sort(keys.begin(), keys.end());
+    for (int i = 0; i < sz; ++i) {
+      idx[i] = keys[i].second;
+    }
+  }
   algo::swap_idx_and_val(idx);
   return idx;
 }
 
 void
 Vertices::swap(int idx1, int idx2) {
+  if (idx1 == idx2) {
+    return;
+  }
+  if (not name_slots_.empty()) {
+    auto slot1 = slot_of(idx1);
+    auto slot2 = slot_of(idx2);
+    std::swap(name_slots_[slot1], name_slots_[slot2]);
+  }
   std::swap(vertices_[idx1], vertices_[idx2]);
-  std::swap(vertex_names_[idx1], vertex_names_[idx2]);
+  std::swap(colors_[idx1], colors_[idx2]);
+  std::swap(start_bits_[idx1], start_bits_[idx2]);
+  std::swap(block_counts_[idx1], block_counts_[idx2]);
+  std::swap(continuations_[idx1], continuations_[idx2]);
+  std::swap(name_refs_[idx1], name_refs_[idx2]);
 }
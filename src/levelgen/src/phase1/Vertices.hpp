@@ -4,8 +4,13 @@
 #include "Vertex.hpp"
 
 #include <array>
+#include <bit>
 #include <cassert>
+#include <cstddef>
 #include <cstdint>
+#include <iterator>
+#include <memory_resource>
+#include <span>
 #include <string>
 #include <string_view>
 #include <vector>
@@ -17,21 +22,86 @@
 // b -> cd
 //
 // The "cd" parts of both rules are identical "tails" and so can merge.
+//
+// Everything is allocated from the memory resource given at construction, so
+// a level can be built in a short-lived arena. Moving keeps the resource;
+// copying (like the pmr containers inside) puts the copy on the default one.
 
 class Vertices {
+  // widths of the fields of sort_key
+  static constexpr int SizeBits   = std::bit_width(vertex::MaxBlocksPerVertex);
+  static constexpr int BlocksBits = vertex::MaxBlocksPerVertex *
+                                    vertex::BitsPerBlock;
+
+  // A vertex name is its color prefix plus a suffix living in the name arena
+  struct NameRef {
+    std::uint32_t       offset;
+    std::uint32_t       length;
+    std::array<char, 2> prefix;
+  };
+
 public:
-  using NameVec        = std::vector<std::string>;
-  using VertexVec      = std::vector<vertex::Vertex>;
-  using iterator       = NameVec::iterator;
-  using const_iterator = NameVec::const_iterator;
-  using size_type      = NameVec::size_type;
+  using NameRefVec = std::pmr::vector<NameRef>;
+  using VertexVec  = std::pmr::vector<vertex::Vertex>;
+  using VertexSpan = std::span<vertex::Vertex const>;
+  using FieldVec   = std::pmr::vector<std::uint8_t>;
+  using RunVec     = std::pmr::vector<VertexVec>;
+  using IndexVec   = std::pmr::vector<int>;
+  using size_type  = NameRefVec::size_type;
+
+  // The two-char printable color that starts every internal name
+  using NamePrefix = std::array<char, 2>;
+
+  // Iterates internal names in vertex order, building each one as it goes.
+  class name_iterator {
+  public:
+    using iterator_category = std::forward_iterator_tag;
+    using value_type        = std::string;
+    using difference_type   = std::ptrdiff_t;
+    using pointer           = void;
+    using reference         = std::string;
+
+    name_iterator() = default;
+    name_iterator(Vertices const * vertices, int idx)
+        : vertices_(vertices), idx_(idx) {
+    }
+
+    std::string
+    operator*() const {
+      return vertices_->name_of(idx_);
+    }
+
+    name_iterator &
+    operator++() {
+      ++idx_;
+      return *this;
+    }
+
+    name_iterator
+    operator++(int) {
+      return {vertices_, idx_++};
+    }
+
+    bool operator==(name_iterator const &) const = default;
 
-  Vertices();
+  private:
+    Vertices const * vertices_ = nullptr;
+    int              idx_      = 0;
+  };
+
+  using iterator       = name_iterator;
+  using const_iterator = name_iterator;
+
+  explicit Vertices(std::pmr::memory_resource * resource =
+                        std::pmr::get_default_resource());
+
+  std::pmr::memory_resource *
+  resource() const {
+    return vertices_.get_allocator().resource();
+  }
 
   size_type      size() const;
   size_type      names_size() const;
-  iterator       names_begin();
-  iterator       names_end();
   const_iterator names_begin() const;
   const_iterator names_end() const;
 
@@ -41,9 +111,9 @@ public:
     return vertices_[idx];
   }
 
-  NameVec const &
+  std::vector<std::string>
   names() const {
-    return vertex_names_;
+    return {names_begin(), names_end()};
   }
 
   VertexVec const &
@@ -51,23 +121,87 @@ public:
     return vertices_;
   }
 
+  // The packed values are the canonical storage. These parallel arrays hold
+  // the fields most often compared across whole graphs, one byte per vertex,
+  // so those scans are byte compares that vectorize instead of decoding each
+  // Vertex in turn. Kept in step with values() by every mutation.
+  FieldVec const &
+  colors() const {
+    return colors_;
+  }
+
+  FieldVec const &
+  start_bits() const {
+    return start_bits_;
+  }
+
+  FieldVec const &
+  block_counts() const {
+    return block_counts_;
+  }
+
+  // A same-color run longer than one vertex holds keeps its later blocks in
+  // continuation records: values packed like vertices of the same color,
+  // without a start bit, and every one but the last full. They live outside
+  // the adjacency matrix, so however long the run it is still one vertex in
+  // the graph. Empty for almost every vertex.
+  VertexSpan
+  continuation_of(int idx) const {
+    return continuations_[idx];
+  }
+
+  // blocks in the vertex and its continuation
+  int run_size(int idx) const;
+
+  // Moves every block of vertex from_idx (continuation included) onto the
+  // end of vertex into_idx, spilling into continuation records as into_idx
+  // fills. The colors must be mergeable. from_idx is left without blocks, for
+  // the caller to remove.
+  void append_run(int into_idx, int from_idx);
+
+  // Replaces the continuation records of vertex idx with a run built
+  // elsewhere, as by StaticGraph
+  void set_continuation(int idx, VertexSpan records);
+
   int name_index_of(std::string_view  vertex,
                     color::FinalColor final_color) const;
   int name_index_of_checked(std::string_view  vertex,
                             color::FinalColor final_color) const;
 
-  std::string const & name_of(int index) const;
+  std::string name_of(int index) const;
+
+  // The two parts of name_of(index), without building the name
+  NamePrefix       prefix_of(int index) const;
+  std::string_view suffix_of(int index) const;
 
   void
   set_vertex(int idx, vertex::Vertex v) {
-    vertices_[idx] = v;
+    vertices_[idx]     = v;
+    colors_[idx]       = +get_final_color(v);
+    start_bits_[idx]   = get_start_bit(v);
+    block_counts_[idx] = vertex::size(v);
   }
 
   bool compatible_number_and_colors(Vertices const & other) const;
 
   // index map shows where items should go if they were sorted by color, num
   // blocks, then block values
-  std::vector<int> compute_sorted_index_map();
+  IndexVec compute_sorted_index_map();
+
+  // The order compute_sorted_index_map sorts by, packed into the high bits of
+  // one integer so that sorting is plain integer comparison. StaticGraph
+  // sorts by it too.
+  static constexpr int SortKeyBits = vertex::BitsForColor + 1 + SizeBits +
+                                     BlocksBits;
+
+  static constexpr std::uint64_t
+  sort_key(vertex::Vertex v) {
+    std::uint64_t key = +get_final_color(v);
+    key               = key << 1 | get_start_bit(v);
+    key               = key << SizeBits | vertex::size(v);
+    key               = key << BlocksBits | (+v & vertex::AllBlocksMask);
+    return key;
+  }
 
   void swap(int idx1, int idx2);
 
@@ -83,18 +217,65 @@ public:
   int add_vertex_single(std::string_view vertex, block::FinalBlock block,
                         color::FinalColor final_color, vertex::VertexRole role);
 
+  // Stores text that vertex names can then refer to by offset, so that all
+  // the suffixes of one chain share a single copy of it. Returns the offset.
+  std::uint32_t add_name_text(std::string_view text);
+
+  // Adds a vertex the caller already knows is new, named by name_length chars
+  // of stored name text. Unlike add_vertex_single this never hashes the name;
+  // the name index is dropped and rebuilt by the next lookup by name.
+  // returns index
+  int append_vertex(std::uint32_t name_offset, std::uint32_t name_length,
+                    block::FinalBlock block, color::FinalColor final_color,
+                    vertex::VertexRole role);
+
   static std::string internal_name(std::string_view  vertex_id_string,
                                    color::FinalColor final_color);
 
+  static NamePrefix name_prefix(color::FinalColor final_color);
+
   std::string pretty_name(int idx) const;
 
   int index_of_internal_name(std::string_view intern_vertex_name) const;
   int index_of_checked_internal_name(std::string_view intern_vertex_name) const;
 
 private:
-  constexpr static int DefaultCapacity = 16;
+  constexpr static int DefaultCapacity      = 16;
+  constexpr static int DefaultArenaCapacity = 256;
+  constexpr static int EmptySlot            = -1;
+
+  // Names are never copied into their own strings: the internal name of
+  // vertex i is its prefix followed by a suffix stored once in name_arena_
+  // and referred to by offset. Lookups hash and compare the (prefix, suffix)
+  // pair in place, so they never build a name either.
+  int find_name(NamePrefix prefix, std::string_view suffix) const;
+
+  // Open-addressing (linear probing) hash index from internal name to vertex
+  // index, so name lookups don't scan every name. Kept at most half full.
+  // Empty when dropped by append_vertex; see ensure_name_index.
+  using SlotVec = std::pmr::vector<int>;
+
+  static std::size_t hash_name(NamePrefix prefix, std::string_view suffix);
+  std::size_t        hash_of(int idx) const;
+  bool        name_equals(int idx, NamePrefix prefix,
+                          std::string_view suffix) const;
+  std::size_t slot_of(NamePrefix prefix, std::string_view suffix) const;
+  std::size_t slot_of(int idx) const;
+  void        index_name(int idx);
+  void        unindex_name(int idx);
+  void        reindex_name(int old_idx, int new_idx);
+  void        rehash(std::size_t num_slots) const;
+  void        ensure_name_index() const;
+
+  void push_vertex(vertex::Vertex v);
 
 private:
-  NameVec   vertex_names_;
-  VertexVec vertices_;
+  std::pmr::string name_arena_;
+  NameRefVec       name_refs_;
+  VertexVec        vertices_;
+  FieldVec         colors_;
+  FieldVec         start_bits_;
+  FieldVec         block_counts_;
+  RunVec           continuations_;
+  mutable SlotVec  name_slots_;
 };
@@ -0,0 +1,99 @@
+// Times the batch vertex kernels against their scalar versions.
+//
+//   vertexbatch_bench [num_vertices [repeats]]
+
+#include "VertexBatch.hpp"
+
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+using vertex::batch::ByteSpan;
+using vertex::batch::VertexSpan;
+
+std::vector<vertex::Vertex>
+random_vertices(std::size_t count) {
+  std::mt19937                                 rng(1234);
+  std::uniform_int_distribution<std::uint32_t> any_color(0, 31);
+  std::uniform_int_distribution<std::uint32_t> any_size(1, 6);
+  std::uniform_int_distribution<std::uint32_t> any_block(1, 15);
+  std::bernoulli_distribution                  is_start(0.25);
+
+  std::vector<vertex::Vertex> vertices(count);
+  for (auto & v : vertices) {
+    vertex::Bits bits = vertex::Bits(any_color(rng)) << vertex::ColorShift;
+    bits |= vertex::Bits(is_start(rng)) << vertex::StartBitShift;
+    for (int i = 0, sz = any_size(rng); i < sz; ++i) {
+      bits |= vertex::Bits(any_block(rng))
+              << vertex::DefaultLayout::block_shift(i);
+    }
+    v = vertex::Vertex{bits};
+  }
+  return vertices;
+}
+
+template <typename KernelT>
+double
+time_kernel(KernelT kernel, VertexSpan in, ByteSpan out, int repeats) {
+  auto start = Clock::now();
+  for (int i = 0; i < repeats; ++i) {
+    kernel(in, out);
+  }
+  std::chrono::duration<double, std::nano> elapsed = Clock::now() - start;
+  return elapsed.count() / (double(repeats) * in.size());
+}
+
+template <typename BatchT, typename ScalarT>
+void
+compare(char const * name, BatchT batch, ScalarT scalar, VertexSpan in,
+        int repeats) {
+  std::vector<std::uint8_t> batch_out(in.size()), scalar_out(in.size());
+
+  double batch_ns  = time_kernel(batch, in, batch_out, repeats);
+  double scalar_ns = time_kernel(scalar, in, scalar_out, repeats);
+
+  std::cout << name << ": " << vertex::batch::implementation() << " "
+            << batch_ns << " ns/vertex, scalar " << scalar_ns
+            << " ns/vertex, speedup " << scalar_ns / batch_ns
+            << (batch_out == scalar_out ? "" : "  ** RESULTS DIFFER **")
+            << "\n";
+}
+
+} // namespace
+
+int
+main(int argc, char * argv[]) {
+  std::size_t count   = argc > 1 ? std::stoul(argv[1]) : 4096;
+  int         repeats = argc > 2 ? std::stoi(argv[2]) : 20000;
+
+  auto const vertices = random_vertices(count);
+  auto const color    = color::FinalColor{7};
+
+  namespace batch  = vertex::batch;
+  namespace scalar = vertex::batch::scalar;
+  compare("sizes", batch::sizes, scalar::sizes, vertices, repeats);
+  compare("final_colors",
+          batch::final_colors,
+          scalar::final_colors,
+          vertices,
+          repeats);
+  compare("start_bits", batch::start_bits, scalar::start_bits, vertices,
+          repeats);
+  compare(
+      "color_mask",
+      [color](VertexSpan in, ByteSpan out) {
+        batch::color_mask(in, color, out);
+      },
+      [color](VertexSpan in, ByteSpan out) {
+        scalar::color_mask(in, color, out);
+      },
+      vertices,
+      repeats);
+}
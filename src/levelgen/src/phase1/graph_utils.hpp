@@ -4,12 +4,22 @@
 
 namespace utils {
 
+// the vertex, then each of its continuation records after a '+'
+inline std::string
+vertex_to_short_name(int idx, GraphCreator const & graph_creator) {
+  auto const & vertices = graph_creator.get_vertices();
+  auto const & xforms   = graph_creator.get_transforms();
+  std::string  result   = to_external_short_name(vertices[idx], xforms);
+  for (auto record : vertices.continuation_of(idx)) {
+    result += "+" + to_external_short_name(record, xforms);
+  }
+  return result;
+}
+
 inline std::string
 visit_children_starting_at(int idx, GraphCreator const & graph_creator) {
   auto const & am     = graph_creator.get_adjacency_matrix();
-  auto const & xforms = graph_creator.get_transforms();
-  auto         vertex = graph_creator.get_vertices()[idx];
-  std::string  result = to_external_short_name(vertex, xforms);
+  std::string  result = vertex_to_short_name(idx, graph_creator);
   if (am.outdegree_of(idx) > 0) {
     am.visit_children_of(idx, [&](int child) {
       auto rest = visit_children_starting_at(child, graph_creator);
@@ -26,8 +36,7 @@ graph_to_string(GraphCreator const & graph_creator) {
   std::string result;
   auto &      am = graph_creator.get_adjacency_matrix();
   am.visit_start_vertices([&](int start) {
-    result += to_external_short_name(graph_creator.get_vertices()[start],
-                                     graph_creator.get_transforms());
+    result += vertex_to_short_name(start, graph_creator);
     am.visit_children_of(start, [&](int child) {
       auto rest = visit_children_starting_at(child, graph_creator) + "\n";
       if (not rest.empty()) {
@@ -0,0 +1,26 @@
+#pragma once
+
+#include <cstdint>
+
+namespace hashing {
+
+// splitmix64 finalizer: cheap, and every input bit affects every output bit,
+// so it is good enough to build feature and band hashes from small integers.
+constexpr std::uint64_t
+mix(std::uint64_t x) {
+  x ^= x >> 30;
+  x *= 0xbf58476d1ce4e5b9ULL;
+  x ^= x >> 27;
+  x *= 0x94d049bb133111ebULL;
+  x ^= x >> 31;
+  return x;
+}
+
+// order-dependent combination of a running hash with another value
+constexpr std::uint64_t
+combine(std::uint64_t seed, std::uint64_t value) {
+  return mix(seed ^
+             (value + 0x9e3779b97f4a7c15ULL + (seed << 6) + (seed >> 2)));
+}
+
+} // namespace hashing
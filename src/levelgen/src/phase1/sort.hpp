@@ -1,12 +1,15 @@
 #pragma once
 
+#include <algorithm>
+#include <array>
+#include <cstdint>
 #include <utility>
 #include <vector>
 
 namespace algo {
 
-template <typename T>
-void inline swap_idx_and_val(std::vector<T> & vec) {
+template <typename T, typename AllocT>
+void inline swap_idx_and_val(std::vector<T, AllocT> & vec) {
   // Prereq: vec must be populated with N unique elements, in range 0-(N-1).
 
   // An array is like a hash from index->value, and this function reverses the
@@ -14,7 +17,7 @@ void inline swap_idx_and_val(std::vector<T> & vec) {
   // allocation.
 
   // Add size to each element to indicate it is not yet processed
-  const auto sz = size(vec);
+  const T sz = size(vec);
   for (auto & e : vec) {
     e += sz;
   }
@@ -32,4 +35,37 @@ void inline swap_idx_and_val(std::vector<T> & vec) {
   }
 }
 
+// Sorts 64-bit keys with a least-significant-digit radix sort, a byte at a
+// time. Bytes that are the same in every key are skipped, so narrow keys only
+// pay for the bytes they use. Tiny inputs go to std::sort, which wins there;
+// both give the same order, as equal keys are indistinguishable.
+template <typename AllocT>
+void inline radix_sort(std::vector<std::uint64_t, AllocT> & keys) {
+  constexpr std::size_t SmallSize = 64;
+  if (keys.size() < SmallSize) {
+    std::sort(begin(keys), end(keys));
+    return;
+  }
+
+  std::vector<std::uint64_t, AllocT> buffer(keys.size(), keys.get_allocator());
+  for (int shift = 0; shift < 64; shift += 8) {
+    std::array<std::size_t, 256> counts{};
+    for (auto key : keys) {
+      ++counts[(key >> shift) & 0xff];
+    }
+    if (counts[(keys.front() >> shift) & 0xff] == keys.size()) {
+      continue; // every key has this byte
+    }
+
+    std::size_t offset = 0;
+    for (auto & count : counts) {
+      offset = std::exchange(count, offset) + offset;
+    }
+    for (auto key : keys) {
+      buffer[counts[(key >> shift) & 0xff]++] = key;
+    }
+    keys.swap(buffer);
+  }
+}
+
 } // namespace algo
@@ -1,6 +1,6 @@
 #include "AdjacencyMatrix.hpp"
 #include "AdjacencyMatrixPrinter.hpp"
-#include "GraphCreator.hpp"
+#include "graph_helpers.hpp"
 #include "jsonlevelconfig.hpp"
 #include "boost/json.hpp"
 #include "gtest/gtest.h"
@@ -232,8 +232,7 @@ TEST(TestAdjacencyMatrixPrinter, test_print_vertices) {
                          from("b") = to("c")
                   ));
   // clang-format on
-  Graph graph =
-      GraphCreator(lvl).compress_vertices().group_by_colors().create();
+  Graph graph = ::test::make_graph(lvl);
 
   auto actual =
       to_string(WithVertices{graph.adjacency_matrix(), graph.vertices()});
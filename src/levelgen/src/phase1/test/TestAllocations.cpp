@@ -0,0 +1,301 @@
+#include "FrozenGraph.hpp"
+#include "Graph.hpp"
+#include "GraphCreator.hpp"
+#include "GraphLoader.hpp"
+#include "LevelStream.hpp"
+
+#include "graph_helpers.hpp"
+#include "jsonlevelconfig.hpp"
+
+#include <boost/json.hpp>
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdlib>
+#include <memory_resource>
+#include <new>
+#include <string>
+#include <utility>
+
+// Every allocation in this test binary goes through here, so a test can check
+// how many a piece of code makes. Building a graph should only ever move its
+// parts along; a copy creeping in shows up as a jump in these counts. Every
+// form of new and delete is replaced (array, over-aligned and nothrow), so
+// every new is counted and each delete frees what its new allocated. The
+// other tests are built without this, into testphase1.
+
+namespace {
+std::atomic<long> num_allocations{0};
+
+void *
+counted_malloc(std::size_t size) noexcept {
+  ++num_allocations;
+  return std::malloc(size ? size : 1);
+}
+
+void *
+counted_aligned_alloc(std::size_t size, std::align_val_t align) noexcept {
+  ++num_allocations;
+  auto alignment = static_cast<std::size_t>(align);
+  // aligned_alloc wants a whole number of alignments
+  auto rounded = (std::max(size, std::size_t(1)) + alignment - 1) /
+                 alignment * alignment;
+  return std::aligned_alloc(alignment, rounded);
+}
+
+void *
+or_throw(void * ptr) {
+  if (ptr) {
+    return ptr;
+  }
+  throw std::bad_alloc();
+}
+} // namespace
+
+void *
+operator new(std::size_t size) {
+  return or_throw(counted_malloc(size));
+}
+
+void *
+operator new[](std::size_t size) {
+  return or_throw(counted_malloc(size));
+}
+
+void *
+operator new(std::size_t size, std::align_val_t align) {
+  return or_throw(counted_aligned_alloc(size, align));
+}
+
+void *
+operator new[](std::size_t size, std::align_val_t align) {
+  return or_throw(counted_aligned_alloc(size, align));
+}
+
+void *
+operator new(std::size_t size, std::nothrow_t const &) noexcept {
+  return counted_malloc(size);
+}
+
+void *
+operator new[](std::size_t size, std::nothrow_t const &) noexcept {
+  return counted_malloc(size);
+}
+
+void *
+operator new(std::size_t size, std::align_val_t align,
+             std::nothrow_t const &) noexcept {
+  return counted_aligned_alloc(size, align);
+}
+
+void *
+operator new[](std::size_t size, std::align_val_t align,
+               std::nothrow_t const &) noexcept {
+  return counted_aligned_alloc(size, align);
+}
+
+void
+operator delete(void * ptr) noexcept {
+  std::free(ptr);
+}
+
+void
+operator delete[](void * ptr) noexcept {
+  std::free(ptr);
+}
+
+void
+operator delete(void * ptr, std::size_t) noexcept {
+  std::free(ptr);
+}
+
+void
+operator delete[](void * ptr, std::size_t) noexcept {
+  std::free(ptr);
+}
+
+void
+operator delete(void * ptr, std::align_val_t) noexcept {
+  std::free(ptr);
+}
+
+void
+operator delete[](void * ptr, std::align_val_t) noexcept {
+  std::free(ptr);
+}
+
+void
+operator delete(void * ptr, std::size_t, std::align_val_t) noexcept {
+  std::free(ptr);
+}
+
+void
+operator delete[](void * ptr, std::size_t, std::align_val_t) noexcept {
+  std::free(ptr);
+}
+
+void
+operator delete(void * ptr, std::nothrow_t const &) noexcept {
+  std::free(ptr);
+}
+
+void
+operator delete[](void * ptr, std::nothrow_t const &) noexcept {
+  std::free(ptr);
+}
+
+void
+operator delete(void * ptr, std::align_val_t,
+                std::nothrow_t const &) noexcept {
+  std::free(ptr);
+}
+
+void
+operator delete[](void * ptr, std::align_val_t,
+                  std::nothrow_t const &) noexcept {
+  std::free(ptr);
+}
+
+namespace test {
+
+template <typename FuncT>
+long
+count_allocations(FuncT func) {
+  long before = num_allocations;
+  func();
+  return num_allocations - before;
+}
+
+using namespace json;
+
+// clang-format off
+auto const april1 = level(rules(from("a")   = to("bc"),
+                                from("b")   = to("cd", "1"),
+                                from("c..") = to("d"),
+                                from("d")   = to("")));
+// clang-format on
+
+// Upper bounds for the level above, a little over what it takes today. A
+// copy of its Vertices alone would be another 9 or so.
+constexpr long MaxGraphConstructorAllocations = 4;
+constexpr long MaxLevelAllocations            = 44;
+
+TEST(TestAllocations, graph_constructor_moves_its_parts) {
+  GraphCreator gc(april1);
+  gc.compress_vertices().group_by_colors();
+  Vertices                vertices         = gc.get_vertices();
+  matrix::AdjacencyMatrix adjacency_matrix = gc.get_adjacency_matrix();
+
+  // the indices, shape keys and permutable ranges are all it should need
+  auto count = count_allocations([&] {
+    Graph graph(std::move(vertices), std::move(adjacency_matrix));
+  });
+  EXPECT_LE(count, MaxGraphConstructorAllocations);
+}
+
+TEST(TestAllocations, moving_a_graph_allocates_nothing) {
+  Graph graph = GraphCreator(april1).create();
+  auto  count = count_allocations([&] { Graph moved = std::move(graph); });
+  EXPECT_EQ(0, count);
+}
+
+TEST(TestAllocations, freezing_a_graph_allocates_once) {
+  Graph graph = make_graph(april1);
+  auto  count = count_allocations([&] { FrozenGraph frozen(graph); });
+  EXPECT_EQ(1, count);
+}
+
+TEST(TestAllocations, level_to_graph) {
+  auto count = count_allocations([&] { Graph graph = make_graph(april1); });
+  EXPECT_LE(count, MaxLevelAllocations);
+}
+
+TEST(TestAllocations, levels_file_to_graphs) {
+  constexpr int NumLevels = 10;
+
+  boost::json::array levels;
+  for (int i = 0; i < NumLevels; ++i) {
+    levels.push_back(april1);
+  }
+  boost::json::value file_json =
+      boost::json::object{std::pair("levels", std::move(levels))};
+
+  // each level as above, plus the graphs as built and as returned, and no
+  // copy of the levels; on one thread, so none for starting threads
+  auto count =
+      count_allocations([&] { p1::create_graphs_from_json(file_json, 1); });
+  EXPECT_LE(count, NumLevels * MaxLevelAllocations + 2);
+}
+
+// Each level's DOM is built in the one reused buffer, which the first level
+// outgrows, so from the second level on streaming allocates nothing. The
+// counts are taken as each level reaches the callback.
+TEST(TestAllocations, streamed_levels_share_one_buffer) {
+  constexpr int NumLevels = 5;
+
+  // a hundred rules, so the level outgrows the initial buffer
+  boost::json::object many_rules;
+  for (char first = 'a'; first < 'k'; ++first) {
+    for (char second = 'a'; second < 'k'; ++second) {
+      many_rules[std::string{first, second}] = boost::json::array{"b", "c"};
+    }
+  }
+  boost::json::array levels;
+  for (int i = 0; i < NumLevels; ++i) {
+    levels.push_back(boost::json::object{std::pair("rules", many_rules)});
+  }
+  auto const text = boost::json::serialize(
+      boost::json::object{std::pair("levels", std::move(levels))});
+
+  std::array<long, NumLevels> seen{};
+  int                         num_seen = 0;
+  p1::for_each_level(text, [&](boost::json::object const &) {
+    seen[num_seen++] = num_allocations;
+  });
+  ASSERT_EQ(NumLevels, num_seen);
+  EXPECT_LT(seen[0], seen[1]); // the buffer grew
+  for (int i = 2; i < NumLevels; ++i) {
+    EXPECT_EQ(seen[i - 1], seen[i]) << "level " << i;
+  }
+}
+
+// Everything GraphCreator and Graph allocate comes from the given resource;
+// null_memory_resource as the upstream makes running out of buffer an error
+// rather than a quiet trip to the heap.
+TEST(TestAllocations, level_built_in_an_arena_uses_only_the_arena) {
+  std::array<std::byte, 1 << 16>      buffer;
+  std::pmr::monotonic_buffer_resource arena(buffer.data(), buffer.size(),
+                                            std::pmr::null_memory_resource());
+  auto count = count_allocations([&] {
+    Graph graph = GraphCreator(april1, &arena)
+                      .compress_vertices()
+                      .group_by_colors()
+                      .create();
+  });
+  EXPECT_EQ(0, count);
+}
+
+TEST(TestAllocations, copying_keeps_a_graph_past_its_arena) {
+  Graph reference = make_graph(april1);
+
+  // nothing built in the arena may outlive it, so only the copy leaves here
+  std::pmr::monotonic_buffer_resource arena;
+  Graph kept = [&] {
+    Graph graph = GraphCreator(april1, &arena)
+                      .compress_vertices()
+                      .group_by_colors()
+                      .create();
+    EXPECT_EQ(&arena, graph.vertices().resource());
+    return Graph(graph);
+  }();
+  EXPECT_EQ(std::pmr::get_default_resource(), kept.vertices().resource());
+  arena.release();
+
+  EXPECT_TRUE(kept.check_isomorphism(reference));
+  EXPECT_EQ(reference.shape_keys(), kept.shape_keys());
+}
+
+} // namespace test
@@ -0,0 +1,185 @@
+#include "FrozenGraph.hpp"
+#include "Graph.hpp"
+
+#include "graph_helpers.hpp"
+#include "jsonlevelconfig.hpp"
+
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+namespace test {
+
+using namespace json;
+
+// clang-format off
+auto const april1 = level(std::pair("name", "april1"),
+                          rules(from("a")    = to("bc"),
+                                from("abcd") = to(""),
+                                from("bc")   = to("bcd", "c"),
+                                from("cbc")  = to("ab"),
+                                from("d")    = to("a", "db"),
+                                from("db")   = to("b")));
+
+// april1 reordered, with its blocks relabeled
+auto const april1_relabeled = level(rules(from("e")    = to("ca"),
+                                          from("bc")   = to("c"),
+                                          from("b")    = to("e", "bc"),
+                                          from("ca")   = to("cab", "a"),
+                                          from("aca")  = to("ec"),
+                                          from("ecab") = to("")));
+
+// april1_relabeled with one rule changed
+auto const april1_differs = level(rules(from("e")    = to("ca"),
+                                        from("bc")   = to(""),
+                                        from("b")    = to("e", "bc"),
+                                        from("ca")   = to("cab", "a"),
+                                        from("aca")  = to("ec"),
+                                        from("ecab") = to("")));
+// clang-format on
+
+TEST(TestFrozenGraph, keeps_everything_about_the_graph) {
+  Graph       graph = make_graph(april1);
+  FrozenGraph frozen(graph);
+
+  ASSERT_EQ(graph.size(), frozen.size());
+  EXPECT_EQ("april1", frozen.level_name());
+  EXPECT_TRUE(std::ranges::equal(graph.shape_keys(), frozen.shape_keys()));
+  ASSERT_EQ(graph.permutable_block_ranges().size(),
+            frozen.permutable_block_ranges().size());
+  for (std::size_t i = 0; i < frozen.permutable_block_ranges().size(); ++i) {
+    EXPECT_EQ(graph.permutable_block_ranges()[i].first,
+              frozen.permutable_block_ranges()[i].first);
+    EXPECT_EQ(graph.permutable_block_ranges()[i].second,
+              frozen.permutable_block_ranges()[i].second);
+  }
+  for (int i = 0; i < graph.size(); ++i) {
+    EXPECT_EQ(graph.vertex_at(i), frozen.vertex_at(i));
+    for (int j = 0; j < graph.size(); ++j) {
+      EXPECT_EQ(graph.has_edge(i, j), frozen.has_edge(i, j));
+    }
+  }
+  EXPECT_EQ(graph.fingerprint(), frozen.fingerprint());
+}
+
+TEST(TestFrozenGraph, keeps_continuation_records) {
+  Graph graph = make_graph(
+      level(rules(from("a") = to(std::string(20, 'b')), from("c") = to(""))));
+  FrozenGraph frozen(graph, false);
+
+  EXPECT_EQ("", frozen.level_name());
+  for (int i = 0; i < graph.size(); ++i) {
+    auto run = graph.continuation_of(i);
+    EXPECT_TRUE(std::ranges::equal(run, frozen.continuation_of(i)));
+  }
+  EXPECT_EQ(graph.fingerprint(), frozen.fingerprint());
+}
+
+TEST(TestFrozenGraph, isomorphism_matches_graph) {
+  Graph graph     = make_graph(april1);
+  Graph relabeled = make_graph(april1_relabeled);
+  Graph differs   = make_graph(april1_differs);
+
+  FrozenGraph frozen(graph);
+  FrozenGraph frozen_relabeled(relabeled);
+  FrozenGraph frozen_differs(differs);
+
+  EXPECT_TRUE(frozen.check_isomorphism(frozen_relabeled));
+  EXPECT_TRUE(frozen.check_isomorphism(relabeled));
+  EXPECT_FALSE(frozen.check_isomorphism(frozen_differs));
+  EXPECT_FALSE(frozen_relabeled.check_isomorphism(differs));
+}
+
+TEST(TestFrozenGraph, round_trips_through_its_words) {
+  FrozenGraph frozen(make_graph(april1));
+
+  // as if written to a file and read (or mapped) back
+  std::vector<FrozenGraph::Word> file(frozen.words().begin(),
+                                      frozen.words().end());
+  FrozenGraphView view(file);
+  EXPECT_EQ(frozen, view);
+  EXPECT_EQ(frozen.hash(), view.hash());
+  EXPECT_EQ("april1", view.level_name());
+
+  FrozenGraph copy = FrozenGraph::from_words(file);
+  file.clear();
+  EXPECT_EQ(frozen, copy);
+  EXPECT_TRUE(copy.check_isomorphism(frozen));
+}
+
+TEST(TestFrozenGraph, rejects_what_it_did_not_write) {
+  FrozenGraph frozen(make_graph(april1));
+
+  std::vector<FrozenGraph::Word> file(frozen.words().begin(),
+                                      frozen.words().end());
+  EXPECT_THROW(FrozenGraphView({file.data(), file.size() - 1}),
+               std::runtime_error);
+  file[0] = 0;
+  EXPECT_THROW(FrozenGraphView{file}, std::runtime_error);
+}
+
+// to find the sections of a frozen graph, to corrupt them
+struct FrozenLayout : FrozenGraphView {
+  using FrozenGraphView::layout_of;
+};
+
+TEST(TestFrozenGraph, rejects_bad_run_starts) {
+  FrozenGraph frozen(make_graph(april1));
+
+  std::vector<FrozenGraph::Word> file(frozen.words().begin(),
+                                      frozen.words().end());
+  auto & hdr = *reinterpret_cast<FrozenGraphView::Header *>(file.data());
+  auto const layout     = FrozenLayout::layout_of(hdr);
+  auto *     run_starts = reinterpret_cast<std::uint32_t *>(
+      file.data() + layout.run_starts);
+  auto * ranges = reinterpret_cast<FrozenGraphView::IndexRange *>(
+      file.data() + layout.ranges);
+  ASSERT_GE(hdr.num_vertices, 2u);
+  ASSERT_GE(hdr.num_ranges, 2u);
+
+  // rows too short for the vertices, though the words add up
+  auto const row_words = hdr.row_words;
+  hdr.row_words        = 0;
+  hdr.num_words = FrozenLayout::layout_of(hdr).num_words;
+  EXPECT_THROW(FrozenGraphView{file}, std::runtime_error);
+  hdr.row_words = row_words;
+  hdr.num_words = layout.num_words;
+  EXPECT_NO_THROW(FrozenGraphView{file});
+
+  // permutable ranges past the last vertex, backwards, and overlapping
+  auto const range = ranges[0];
+  ranges[0].second = hdr.num_vertices + 1;
+  EXPECT_THROW(FrozenGraphView{file}, std::runtime_error);
+  ranges[0] = {range.second, range.first};
+  EXPECT_THROW(FrozenGraphView{file}, std::runtime_error);
+  ranges[0] = {range.first, ranges[1].first + 1};
+  EXPECT_THROW(FrozenGraphView{file}, std::runtime_error);
+  ranges[0] = range;
+  EXPECT_NO_THROW(FrozenGraphView{file});
+
+  // past the end of the records
+  run_starts[hdr.num_vertices] += 1;
+  EXPECT_THROW(FrozenGraphView{file}, std::runtime_error);
+  run_starts[hdr.num_vertices] -= 1;
+  EXPECT_NO_THROW(FrozenGraphView{file});
+
+  // going backwards
+  run_starts[1] = hdr.num_records + 1;
+  EXPECT_THROW(FrozenGraphView{file}, std::runtime_error);
+  EXPECT_THROW(FrozenGraph::from_words(file), std::runtime_error);
+}
+
+TEST(TestFrozenGraph, identical_graphs_dedupe_by_value) {
+  std::unordered_set<FrozenGraph> seen;
+  EXPECT_TRUE(seen.insert(FrozenGraph(make_graph(april1))).second);
+  EXPECT_FALSE(seen.insert(FrozenGraph(make_graph(april1))).second);
+  // isomorphic, but not identical
+  EXPECT_TRUE(seen.insert(FrozenGraph(make_graph(april1_relabeled))).second);
+}
+
+} // namespace test
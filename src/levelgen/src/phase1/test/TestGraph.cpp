@@ -2,18 +2,19 @@
 #include "AdjacencyMatrix.hpp"
 #include "Color.hpp"
 #include "Graph.hpp"
-#include "GraphCreator.hpp"
 #include "jsonutil.hpp"
 #include "Vertex.hpp"
 #include "Vertices.hpp"
 
 #include "color_constants.hpp"
+#include "graph_helpers.hpp"
 #include "jsonlevelconfig.hpp"
 
 #include <gtest/gtest.h>
 #include <boost/json.hpp>
 
 using namespace test::json;
+using test::make_graph;
 using namespace boost;
 using enum vertex::VertexRole;
 
@@ -24,13 +25,11 @@ test_isomorphism(json::object level1, json::object level2, bool dump = false) {
   if (dump) {
     std::cout << "Creating Graph1\n";
   }
-  Graph graph1 =
-      GraphCreator(level1).compress_vertices().group_by_colors().create();
+  Graph graph1 = make_graph(level1);
   if (dump) {
     std::cout << "Creating Graph2\n";
   }
-  Graph graph2 =
-      GraphCreator(level2).compress_vertices().group_by_colors().create();
+  Graph graph2 = make_graph(level2);
 
   if (dump) {
     graph1.dump("Graph1");
@@ -288,3 +287,74 @@ TEST(TestGraph, test_level_reordered) {
   // clang-format on
   EXPECT_TRUE(test_isomorphism(lvl1, lvl2));
 }
+
+TEST(TestGraph, long_runs_compare_their_continuations) {
+  std::string const b20(20, 'b');
+
+  auto lvl = level(rules(from("a") = to(b20)));
+  auto relabeled = level(rules(from("c") = to(std::string(20, 'd'))));
+  EXPECT_TRUE(test_isomorphism(lvl, relabeled));
+
+  // these differ only past the first 6 blocks of the run
+  auto longer   = level(rules(from("a") = to(b20 + "b")));
+  auto last_blk = level(rules(from("a") = to(b20.substr(1) + "c")));
+  EXPECT_FALSE(test_isomorphism(lvl, longer));
+  EXPECT_FALSE(test_isomorphism(lvl, last_blk));
+}
+
+TEST(TestGraph, wl_features_isomorphic_levels_are_identical) {
+  // clang-format off
+  auto lvl1 = level(rules(from("a")    = to("bc"),
+                          from("abcd") = to(""),
+                          from("bc")   = to("bcd", "c"),
+                          from("d")    = to("a", "db")));
+
+  auto lvl2 = level(rules(from("bc")   = to("bcd", "c"),
+                          from("e")    = to("bc"),
+                          from("d")    = to("e", "db"),
+                          from("ebcd") = to("")));
+  // clang-format on
+  Graph graph1 = make_graph(lvl1);
+  Graph graph2 = make_graph(lvl2);
+  ASSERT_TRUE(graph1.check_isomorphism(graph2));
+  EXPECT_EQ(graph1.wl_features(), graph2.wl_features());
+  EXPECT_EQ(graph1.minhash_signature(), graph2.minhash_signature());
+}
+
+TEST(TestGraph, wl_features_differ_by_one_rule) {
+  // clang-format off
+  auto lvl1 = level(rules(from("a")  = to("bc"),
+                          from("b")  = to("c"),
+                          from("cc") = to("")));
+  auto lvl2 = level(rules(from("a")  = to("bc"),
+                          from("b")  = to("c"),
+                          from("cc") = to("a")));
+  // clang-format on
+  auto sig1 = make_graph(lvl1).minhash_signature();
+  auto sig2 = make_graph(lvl2).minhash_signature();
+
+  double similarity = minhash::estimate_similarity(sig1, sig2);
+  EXPECT_GT(similarity, 0.0);
+  EXPECT_LT(similarity, 1.0);
+}
+
+TEST(TestGraph, wl_features_block_pattern_matters) {
+  // "aa" and "ab" have the same shape and colors, but one repeats its block
+  auto lvl1 = level(rules(from("aa") = to("")));
+  auto lvl2 = level(rules(from("ab") = to("")));
+  EXPECT_NE(make_graph(lvl1).wl_features(), make_graph(lvl2).wl_features());
+}
+
+TEST(TestGraph, shape_keys_rule_out_before_mapping) {
+  auto graph1 = make_graph(level(rules(from("ab") = to("c"))));
+  auto graph2 = make_graph(level(rules(from("cd") = to("a"))));
+  auto graph3 = make_graph(level(rules(from("ab") = to("cd"))));
+
+  // same colors, start bits and sizes, in any order
+  EXPECT_EQ(graph1.shape_keys(), graph2.shape_keys());
+  EXPECT_TRUE(graph1.check_isomorphism(graph2));
+
+  // a longer "to" chain can't be mapped onto the shorter one
+  EXPECT_NE(graph1.shape_keys(), graph3.shape_keys());
+  EXPECT_FALSE(graph1.check_isomorphism(graph3));
+}
@@ -59,6 +59,38 @@ TEST(TestGraphCreator, simple_rule2) {
             actual);
 }
 
+TEST(TestGraphCreator, rules_share_chain_tails) {
+  auto lvl = level(rules(from("a") = to("bcd"), from("b") = to("cd", "d")));
+
+  // "cd" and "d" are tails of "bcd", so use its vertices
+  auto actual = vertex_names(lvl);
+  EXPECT_EQ(expected({color::test::short_string::rect_fm + "a",
+                      color::test::short_string::rect_fm + "b",
+                      color::test::short_string::rect_to + "bcd",
+                      color::test::short_string::rect_to + "cd",
+                      color::test::short_string::rect_to + "d"}),
+            actual);
+}
+
+TEST(TestGraphCreator, long_chain_tails_are_found_by_name) {
+  std::string chain(300, 'a');
+  for (std::size_t i = 0; i < chain.size(); i += 3) {
+    chain[i] = 'b';
+  }
+  auto lvl =
+      level(rules(from("a") = to(chain), from("b") = to(chain.substr(1))));
+
+  GraphCreator     gc(lvl);
+  Vertices const & verts = gc.get_vertices();
+  EXPECT_EQ(chain.size() + 2, verts.size());
+
+  auto tail     = chain.substr(200);
+  auto tail_idx = verts.name_index_of(tail, color::test::fc::rect_to);
+  ASSERT_NE(-1, tail_idx);
+  EXPECT_EQ(tail, verts.suffix_of(tail_idx));
+  EXPECT_EQ(1, gc.get_adjacency_matrix().indegree_of(tail_idx));
+}
+
 TEST(TestGraphCreator, rule3_with_transform) {
   // clang-format off
   auto lvl = level(
@@ -311,4 +343,99 @@ TEST(TestGraphCreator, remove_group_by_color) {
   EXPECT_TRUE(adjmtx.has_edge(ww_idx, noth_idx));
 }
 
+TEST(TestGraphCreator, compress_long_chain) {
+  // 20 blocks of the same color stay one vertex: as many as fit in the vertex
+  // itself (6 in the 32-bit layout), the rest in continuation records of up
+  // to as many again
+  constexpr int MaxBlocks = vertex::MaxBlocksPerVertex;
+  auto lvl = level(rules(from("a") = to(std::string(20, 'b'))));
+
+  GraphCreator gc(lvl);
+  gc.compress_vertices();
+  Vertices const & verts = gc.get_vertices();
+  ASSERT_EQ(2, verts.size());
+  EXPECT_EQ(2, gc.get_adjacency_matrix().size());
+
+  using namespace color::test::fc;
+  int run_idx = verts.name_index_of(std::string(20, 'b'), rect_to);
+  ASSERT_NE(-1, run_idx);
+  EXPECT_EQ(20, verts.run_size(run_idx));
+  EXPECT_EQ(MaxBlocks, vertex::size(verts[run_idx]));
+
+  std::vector<int> sizes, expected_sizes;
+  for (auto record : verts.continuation_of(run_idx)) {
+    sizes.push_back(vertex::size(record));
+  }
+  for (int left = 20 - MaxBlocks; left > 0; left -= MaxBlocks) {
+    expected_sizes.push_back(std::min(left, MaxBlocks));
+  }
+  EXPECT_EQ(expected_sizes, sizes);
+
+  int a_idx = verts.name_index_of("a", rect_fm);
+  EXPECT_TRUE(verts.continuation_of(a_idx).empty());
+  EXPECT_TRUE(gc.get_adjacency_matrix().has_edge(a_idx, run_idx));
+}
+
+TEST(TestGraphCreator, compress_long_chain_to_string) {
+  constexpr int MaxBlocks = vertex::MaxBlocksPerVertex;
+  auto lvl =
+      level(rules(from("a") = to(std::string(MaxBlocks + 2, 'b') + "c")));
+
+  GraphCreator gc(lvl);
+  gc.compress_vertices();
+  EXPECT_EQ("[FR:START:a]->[TR:" + std::string(MaxBlocks, 'b') + "]+[TR:bbc]\n",
+            utils::graph_to_string(gc));
+}
+
+TEST(TestGraphCreator, minimize_merges_equivalent_spellings) {
+  // 'a' and '1' are both the first block of the same custom color, so "ab"
+  // and "1b" are spelled differently but are the same vertices.
+  // clang-format off
+  auto lvl = level(
+                 rules(from("e") = to("ab"),
+                       from("f") = to("1b")),
+                 type_overrides(
+                     std::pair("a", rotating_colors("cd")),
+                     std::pair("1", rotating_colors("cd"))));
+  // clang-format on
+
+  GraphCreator     gc(lvl);
+  Vertices const & verts = gc.get_vertices();
+  ASSERT_EQ(5, verts.size());
+
+  gc.minimize_vertices();
+  ASSERT_EQ(4, verts.size());
+  EXPECT_EQ(4, gc.get_adjacency_matrix().size());
+
+  using namespace color::test::fc;
+  int e_idx  = verts.name_index_of("e", rect_fm);
+  int f_idx  = verts.name_index_of("f", rect_fm);
+  int b_idx  = verts.name_index_of("b", rect_to);
+  int ab_idx = verts.name_index_of("ab", cust_to);
+  ASSERT_NE(-1, ab_idx);
+  EXPECT_EQ(-1, verts.name_index_of("1b", cust_to)); // merged into "ab"
+
+  auto const & adjmtx = gc.get_adjacency_matrix();
+  EXPECT_TRUE(adjmtx.has_edge(e_idx, ab_idx));
+  EXPECT_TRUE(adjmtx.has_edge(f_idx, ab_idx));
+  EXPECT_TRUE(adjmtx.has_edge(ab_idx, b_idx));
+  EXPECT_EQ(1, adjmtx.outdegree_of(ab_idx));
+  EXPECT_EQ(2, adjmtx.indegree_of(ab_idx));
+}
+
+TEST(TestGraphCreator, minimize_keeps_different_tails) {
+  // clang-format off
+  auto lvl = level(
+                 rules(from("e") = to("ab"),
+                       from("f") = to("1c")),
+                 type_overrides(
+                     std::pair("a", rotating_colors("cd")),
+                     std::pair("1", rotating_colors("cd"))));
+  // clang-format on
+
+  GraphCreator gc(lvl);
+  gc.compress_vertices().minimize_vertices();
+  EXPECT_EQ(6, gc.get_vertices().size());
+}
+
 } // namespace test
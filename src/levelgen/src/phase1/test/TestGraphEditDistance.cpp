@@ -0,0 +1,71 @@
+#include "Graph.hpp"
+#include "GraphEditDistance.hpp"
+
+#include "graph_helpers.hpp"
+#include "jsonlevelconfig.hpp"
+
+#include <gtest/gtest.h>
+#include <boost/json.hpp>
+
+namespace test {
+
+using namespace json;
+
+TEST(TestGraphEditDistance, identical) {
+  auto graph = make_graph(level(rules(from("a") = to("bc"))));
+  EXPECT_EQ(0, graph_edit_distance(graph, graph, 0));
+  EXPECT_EQ(0, graph_edit_distance(graph, graph, 5));
+}
+
+TEST(TestGraphEditDistance, isomorphic) {
+  // clang-format off
+  auto graph1 = make_graph(level(rules(from("a") = to("b"),
+                                       from("b") = to("c"))));
+  auto graph2 = make_graph(level(rules(from("c") = to("a"),
+                                       from("b") = to("c"))));
+  // clang-format on
+  EXPECT_EQ(0, graph_edit_distance(graph1, graph2, 0));
+}
+
+TEST(TestGraphEditDistance, one_vertex_relabeled) {
+  // "b" and "" are different colors: a single relabel
+  auto graph1 = make_graph(level(rules(from("a") = to("b"))));
+  auto graph2 = make_graph(level(rules(from("a") = to(""))));
+  EXPECT_EQ(1, graph_edit_distance(graph1, graph2, 3));
+  EXPECT_EQ(std::nullopt, graph_edit_distance(graph1, graph2, 0));
+}
+
+TEST(TestGraphEditDistance, extra_rule) {
+  // second graph has one extra vertex (F:c) and one extra edge (F:c->T:!)
+  // clang-format off
+  auto graph1 = make_graph(level(rules(from("a") = to(""))));
+  auto graph2 = make_graph(level(rules(from("a") = to(""),
+                                       from("c") = to(""))));
+  // clang-format on
+  EXPECT_EQ(2, graph_edit_distance(graph1, graph2, 2));
+  EXPECT_EQ(2, graph_edit_distance(graph2, graph1, 10));
+  EXPECT_EQ(std::nullopt, graph_edit_distance(graph1, graph2, 1));
+}
+
+TEST(TestGraphEditDistance, symmetric) {
+  // clang-format off
+  auto graph1 = make_graph(level(rules(from("ab") = to("b"),
+                                       from("b")  = to(""))));
+  auto graph2 = make_graph(level(rules(from("abbb") = to(""),
+                                       from("b")    = to("bb", ""))));
+  // clang-format on
+  auto d12 = graph_edit_distance(graph1, graph2, 20);
+  auto d21 = graph_edit_distance(graph2, graph1, 20);
+  ASSERT_TRUE(d12.has_value());
+  EXPECT_GT(*d12, 0);
+  EXPECT_EQ(d12, d21);
+  EXPECT_EQ(std::nullopt, graph_edit_distance(graph1, graph2, *d12 - 1));
+  EXPECT_EQ(d12, graph_edit_distance(graph1, graph2, *d12));
+}
+
+TEST(TestGraphEditDistance, negative_bound) {
+  auto graph = make_graph(level(rules(from("a") = to("b"))));
+  EXPECT_EQ(std::nullopt, graph_edit_distance(graph, graph, -1));
+}
+
+} // namespace test
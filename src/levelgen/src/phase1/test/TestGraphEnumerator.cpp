@@ -0,0 +1,94 @@
+#include "GraphCreator.hpp"
+#include "GraphEnumerator.hpp"
+
+#include "color_constants.hpp"
+#include "jsonlevelconfig.hpp"
+
+#include <gtest/gtest.h>
+#include <boost/json.hpp>
+#include <stdexcept>
+
+namespace test {
+
+using namespace json;
+using namespace color::test;
+
+namespace {
+
+std::vector<Graph>
+enumerate_all(EnumerationConfig const & config) {
+  std::vector<Graph> graphs;
+  GraphEnumerator    enumerator(config);
+  int count = enumerator.enumerate([&](Graph && g) {
+    graphs.push_back(std::move(g));
+  });
+  EXPECT_EQ(count, graphs.size());
+  return graphs;
+}
+
+} // namespace
+
+TEST(TestGraphEnumerator, invalid_config) {
+  EXPECT_THROW(GraphEnumerator({0, {fc::rect_to}}), std::runtime_error);
+  EXPECT_THROW(GraphEnumerator({9, {fc::rect_to}}), std::runtime_error);
+  EXPECT_THROW(GraphEnumerator({2, {}}), std::runtime_error);
+  EXPECT_THROW(GraphEnumerator({2, {fc::rect_to}, 0}), std::runtime_error);
+}
+
+TEST(TestGraphEnumerator, unlabeled_dags) {
+  // With one label this is every DAG: 1, 2, 6, 31 on 1..4 vertices (OEIS
+  // A003087)
+  EnumerationConfig config{4, {fc::rect_to}, 1, false};
+  EXPECT_EQ(1 + 2 + 6 + 31, enumerate_all(config).size());
+}
+
+TEST(TestGraphEnumerator, relabeled_blocks_are_isomorphic) {
+  // Single vertex: block 1 and block 2 are the same after relabeling.
+  // Two vertices: blocks {1,1} or {1,2}, each with or without an edge.
+  EnumerationConfig config{2, {fc::rect_to}, 2, false};
+  EXPECT_EQ(1 + 4, enumerate_all(config).size());
+
+  // BACKREF blocks are fixed, and cannot be relabeled
+  config.colors = {fc::bref_to};
+  config.max_vertices = 1;
+  EXPECT_EQ(2, enumerate_all(config).size());
+}
+
+TEST(TestGraphEnumerator, no_two_are_isomorphic) {
+  EnumerationConfig config{4, {fc::rect_fm, fc::rect_to, fc::noth_to}, 1};
+  auto graphs = enumerate_all(config);
+  ASSERT_FALSE(graphs.empty());
+  for (std::size_t i = 0; i < graphs.size(); ++i) {
+    for (std::size_t j = i + 1; j < graphs.size(); ++j) {
+      EXPECT_FALSE(graphs[i].check_isomorphism(graphs[j]))
+          << graphs[i].level_name() << " vs " << graphs[j].level_name();
+    }
+  }
+}
+
+TEST(TestGraphEnumerator, finds_level_graphs) {
+  // check_isomorphism lets two blocks map onto one, so only one block is used
+  // here to get an exact count
+  EnumerationConfig config{4, {fc::rect_fm, fc::rect_to, fc::noth_to}, 1};
+  auto graphs = enumerate_all(config);
+
+  // clang-format off
+  auto lvls = {level(rules(from("a")  = to("a"))),
+               level(rules(from("a")  = to(""))),
+               level(rules(from("aa") = to("a"))),
+               level(rules(from("a")  = to("a", ""))),
+               level(rules(from("aa") = to("a", ""))),
+               level(rules(from("a")  = to("a"),
+                           from("aa") = to("")))};
+  // clang-format on
+  for (auto const & lvl : lvls) {
+    Graph level_graph = GraphCreator(lvl).group_by_colors().create();
+    int   matches     = std::count_if(
+        begin(graphs), end(graphs), [&](Graph const & g) {
+          return level_graph.check_isomorphism(g);
+        });
+    EXPECT_EQ(1, matches) << serialize(lvl);
+  }
+}
+
+} // namespace test
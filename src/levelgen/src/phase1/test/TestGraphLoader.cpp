@@ -0,0 +1,93 @@
+#include "Graph.hpp"
+#include "GraphLoader.hpp"
+
+#include "jsonlevelconfig.hpp"
+
+#include <boost/json.hpp>
+#include <gtest/gtest.h>
+
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace test {
+
+using namespace json;
+
+// levels named "L0", "L1", ... of different sizes, so that they take
+// different times to build, except that level bad_idx has no rules, and level
+// bad_type_idx overrides a block with a type that doesn't exist
+static boost::json::value
+levels_file(int num_levels, int bad_idx = -1, int bad_type_idx = -1) {
+  boost::json::array levels;
+  for (int i = 0; i < num_levels; ++i) {
+    if (i == bad_idx) {
+      levels.push_back(level(std::pair("name", "no rules")));
+      continue;
+    }
+    if (i == bad_type_idx) {
+      auto bad_type = boost::json::object{std::pair("type", "NoSuchType")};
+      levels.push_back(level(std::pair("name", "bad type"),
+                             type_overrides(std::pair("a", bad_type)),
+                             rules(from("a") = to(""))));
+      continue;
+    }
+    levels.push_back(level(std::pair("name", "L" + std::to_string(i)),
+                           rules(from("a") = to(std::string(i % 7 + 1, 'b')),
+                                 from("b") = to("c", ""),
+                                 from("c") = to("a"))));
+  }
+  return boost::json::object{std::pair("levels", std::move(levels))};
+}
+
+TEST(TestGraphLoader, graphs_come_back_in_level_order) {
+  auto file_json = levels_file(50);
+
+  std::vector<Graph> serial   = p1::create_graphs_from_json(file_json, 1);
+  std::vector<Graph> parallel = p1::create_graphs_from_json(file_json, 4);
+
+  ASSERT_EQ(50, serial.size());
+  ASSERT_EQ(50, parallel.size());
+  for (int i = 0; i < 50; ++i) {
+    EXPECT_EQ("L" + std::to_string(i), parallel[i].level_name());
+    EXPECT_EQ(serial[i].fingerprint(), parallel[i].fingerprint());
+    EXPECT_TRUE(serial[i].check_isomorphism(parallel[i]));
+  }
+}
+
+TEST(TestGraphLoader, more_threads_than_levels) {
+  auto file_json = levels_file(3);
+  EXPECT_EQ(3, p1::create_graphs_from_json(file_json, 16).size());
+  EXPECT_EQ(3, p1::create_graphs_from_json(file_json, p1::AllThreads).size());
+}
+
+TEST(TestGraphLoader, errors_from_any_thread_are_rethrown) {
+  auto file_json = levels_file(20, 13);
+  EXPECT_THROW(p1::create_graphs_from_json(file_json, 4), std::runtime_error);
+}
+
+// Whichever thread gets there first, the error is the first bad level's, and
+// the levels before it are reported as they would be one at a time.
+TEST(TestGraphLoader, first_bad_level_is_the_one_rethrown) {
+  auto file_json = levels_file(20, 12, 5);
+
+  std::string expected_output;
+  for (int i = 0; i < 5; ++i) {
+    expected_output += "creating: L" + std::to_string(i) + "\n";
+  }
+
+  for (int num_threads : {1, 4, 4, 4, 16}) {
+    testing::internal::CaptureStdout();
+    try {
+      p1::create_graphs_from_json(file_json, num_threads);
+      ADD_FAILURE() << "no exception with " << num_threads << " threads";
+    }
+    catch (std::runtime_error const & e) {
+      EXPECT_EQ("Unknown type_override: NoSuchType", std::string(e.what()));
+    }
+    EXPECT_EQ(expected_output, testing::internal::GetCapturedStdout());
+  }
+}
+
+} // namespace test
@@ -0,0 +1,85 @@
+#include "Graph.hpp"
+#include "GraphPack.hpp"
+
+#include "graph_helpers.hpp"
+#include "jsonlevelconfig.hpp"
+
+#include <gtest/gtest.h>
+
+#include <filesystem>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace test {
+
+using namespace json;
+namespace fs = std::filesystem;
+
+static std::vector<Graph>
+some_graphs() {
+  std::vector<Graph> graphs;
+  for (int i = 0; i < 5; ++i) {
+    graphs.push_back(
+        make_graph(level(std::pair("name", "L" + std::to_string(i)),
+                         rules(from("a") = to(std::string(i * 4 + 1, 'b')),
+                               from("b") = to("c", ""),
+                               from("c") = to("a")))));
+  }
+  return graphs;
+}
+
+TEST(TestGraphPack, maps_back_what_was_written) {
+  auto graphs = some_graphs();
+  auto path   = fs::temp_directory_path() / "levelgen_graphs.lgp";
+  p1::write_graph_pack(path.string(), graphs);
+
+  p1::GraphPack pack(path.string());
+  ASSERT_EQ(graphs.size(), pack.size());
+  for (int i = 0; i < pack.size(); ++i) {
+    FrozenGraphView graph = pack[i];
+    EXPECT_EQ(graphs[i].level_name(), graph.level_name());
+    EXPECT_EQ(graphs[i].fingerprint(), pack.fingerprint(i));
+    EXPECT_EQ(graph.fingerprint(), pack.fingerprint(i));
+    EXPECT_TRUE(graph.check_isomorphism(graphs[i]));
+    EXPECT_EQ(FrozenGraph(graphs[i]), graph);
+  }
+
+  // the same words as pack_graphs gives, though written a graph at a time
+  using Word = p1::GraphPackView::Word;
+  auto words = p1::pack_graphs(graphs);
+  ASSERT_EQ(words.size() * sizeof(Word), fs::file_size(path));
+  std::vector<Word> file_words(words.size());
+  std::ifstream(path, std::ios::binary)
+      .read(reinterpret_cast<char *>(file_words.data()),
+            file_words.size() * sizeof(Word));
+  EXPECT_EQ(words, file_words);
+  fs::remove(path);
+}
+
+TEST(TestGraphPack, empty_pack) {
+  auto words = p1::pack_graphs({});
+  EXPECT_EQ(0, p1::GraphPackView(words).size());
+}
+
+TEST(TestGraphPack, rejects_what_it_did_not_write) {
+  auto graphs = some_graphs();
+  auto words  = p1::pack_graphs(graphs);
+
+  EXPECT_THROW(p1::GraphPackView({words.data(), words.size() - 1}),
+               std::runtime_error);
+  auto bad_offset = words;
+  bad_offset[3]   = words.size(); // the first graph's offset
+  EXPECT_THROW(p1::GraphPackView{bad_offset}, std::runtime_error);
+  words[0] = 0;
+  EXPECT_THROW(p1::GraphPackView{words}, std::runtime_error);
+
+  auto path = fs::temp_directory_path() / "levelgen_not_a_pack.lgp";
+  std::ofstream(path) << "{\"levels\": []}";
+  EXPECT_THROW(p1::GraphPack(path.string()), std::runtime_error);
+  fs::remove(path);
+}
+
+} // namespace test
@@ -0,0 +1,137 @@
+#include "Graph.hpp"
+#include "LevelParser.hpp"
+
+#include "graph_helpers.hpp"
+
+#include <boost/json.hpp>
+#include <gtest/gtest.h>
+
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace test {
+
+static std::vector<Graph>
+parsed_graphs(std::string_view json_text) {
+  std::vector<Graph> graphs;
+  p1::parse_graphs(json_text,
+                   [&](Graph && graph) { graphs.push_back(std::move(graph)); });
+  return graphs;
+}
+
+// the same levels, through a json::value and GraphCreator
+static std::vector<Graph>
+created_graphs(std::string_view json_text) {
+  std::vector<Graph> graphs;
+  auto               file_json = boost::json::parse(json_text);
+  for (auto const & level : file_json.at("levels").as_array()) {
+    graphs.push_back(make_graph(level.as_object()));
+  }
+  return graphs;
+}
+
+static void
+expect_same_graphs(std::string_view json_text) {
+  auto parsed  = parsed_graphs(json_text);
+  auto created = created_graphs(json_text);
+  ASSERT_EQ(created.size(), parsed.size());
+  for (std::size_t i = 0; i < created.size(); ++i) {
+    EXPECT_EQ(created[i].level_name(), parsed[i].level_name());
+    EXPECT_EQ(created[i].fingerprint(), parsed[i].fingerprint());
+    EXPECT_TRUE(created[i].check_isomorphism(parsed[i]));
+  }
+}
+
+TEST(TestLevelParser, builds_the_same_graphs_as_graph_creator) {
+  expect_same_graphs(R"({
+    "version": 1,
+    "levels": [
+      {"name": "chain", "rows": ["a"],
+       "rules": {"a": ["b"], "b": ["c"], "c": [""]}},
+      {"name": "choice", "rows": ["abba"],
+       "rules": {"ab": ["a", "b", "c"], "ba": ["b", "c", "a"], "c": [""]}},
+      {"rules": {"abcd": [""], "a": ["bc"], "bc": ["bcd", "c"]},
+       "name": "name last"}
+    ],
+    "after": {"levels": "not these"}
+  })");
+}
+
+TEST(TestLevelParser, type_overrides_before_or_after_rules) {
+  expect_same_graphs(R"({"levels": [
+    {"name": "after",
+     "rules": {"ab": ["ba"], "a": [""]},
+     "type_overrides": {"a": {"type": "RotatingColors", "cycle_chars": "ab"}}},
+    {"name": "before",
+     "type_overrides": {"a": {"type": "RotatingColors", "cycle_chars": "ab"}},
+     "rules": {"ab": ["ba"], "a": [""]}}
+  ]})");
+
+  auto graphs = parsed_graphs(R"({"levels": [
+    {"rules": {"ab": ["ba"]},
+     "type_overrides": {"a": {"type": "RotatingColors", "cycle_chars": "ab"}}},
+    {"type_overrides": {"a": {"type": "RotatingColors", "cycle_chars": "ab"}},
+     "rules": {"ab": ["ba"]}},
+    {"rules": {"ab": ["ba"]}}
+  ]})");
+  ASSERT_EQ(3, graphs.size());
+  EXPECT_TRUE(graphs[0].check_isomorphism(graphs[1]));
+  EXPECT_FALSE(graphs[0].check_isomorphism(graphs[2]));
+}
+
+TEST(TestLevelParser, type_override_settings_may_nest) {
+  // as GraphCreator does, settings the override type doesn't use are ignored,
+  // whatever they hold
+  expect_same_graphs(R"({"levels": [
+    {"name": "after",
+     "rules": {"ab": ["ba"], "a": [""]},
+     "type_overrides": {"a": {"type": "RotatingColors", "cycle_chars": "ab",
+                              "notes": {"tags": ["x", 2, null], "ok": true}}}},
+    {"name": "before",
+     "type_overrides": {"a": {"notes": [[], {}], "type": "RotatingColors",
+                              "cycle_chars": "ab"}},
+     "rules": {"ab": ["ba"], "a": [""]}}
+  ]})");
+
+  auto graphs = parsed_graphs(R"({"levels": [
+    {"rules": {"ab": ["ba"]},
+     "type_overrides": {"a": {"type": "RotatingColors", "cycle_chars": "ab",
+                              "notes": {"tags": ["x"]}}}},
+    {"rules": {"ab": ["ba"]},
+     "type_overrides": {"a": {"type": "RotatingColors", "cycle_chars": "ab"}}}
+  ]})");
+  ASSERT_EQ(2, graphs.size());
+  EXPECT_EQ(graphs[1].fingerprint(), graphs[0].fingerprint());
+  EXPECT_TRUE(graphs[0].check_isomorphism(graphs[1]));
+}
+
+TEST(TestLevelParser, escaped_strings_are_whole) {
+  // escapes make the parser hand over its own copy, maybe in pieces
+  expect_same_graphs(R"({"levels": [
+    {"name": "say \"hi\"", "rules": {"ab": ["bc"], "bc": [""]}}
+  ]})");
+}
+
+TEST(TestLevelParser, rejects_what_is_not_a_level_file) {
+  EXPECT_THROW(parsed_graphs(R"({"level": []})"), std::runtime_error);
+  EXPECT_THROW(parsed_graphs(R"([])"), std::runtime_error);
+  EXPECT_THROW(parsed_graphs(R"({"levels": {}})"), std::runtime_error);
+  EXPECT_THROW(parsed_graphs(R"({"levels": [[]]})"), std::runtime_error);
+  EXPECT_THROW(parsed_graphs(R"({"levels": [{"name": "x"}]})"),
+               std::runtime_error);
+  EXPECT_THROW(parsed_graphs(R"({"levels": [{"rules": {"a": "b"}}]})"),
+               std::runtime_error);
+  EXPECT_THROW(parsed_graphs(R"({"levels": [{"rules": {"a": [1]}}]})"),
+               std::runtime_error);
+  EXPECT_THROW(parsed_graphs(R"({"levels": [{"rules": {"a": [""]})"),
+               std::runtime_error);
+
+  // one document, then nothing but whitespace
+  EXPECT_THROW(parsed_graphs(R"({"levels": []} [])"), std::runtime_error);
+  EXPECT_THROW(parsed_graphs(R"({"levels": []} junk)"), std::runtime_error);
+  EXPECT_NO_THROW(parsed_graphs("{\"levels\": []}\n"));
+}
+
+} // namespace test
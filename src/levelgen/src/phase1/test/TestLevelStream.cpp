@@ -0,0 +1,125 @@
+#include "Graph.hpp"
+#include "GraphLoader.hpp"
+#include "LevelStream.hpp"
+
+#include "jsonlevelconfig.hpp"
+
+#include <boost/json.hpp>
+#include <gtest/gtest.h>
+
+#include <filesystem>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace test {
+
+using namespace json;
+namespace fs = std::filesystem;
+
+static std::string
+level_names(std::string_view json_text) {
+  std::string names;
+  p1::for_each_level(json_text, [&](boost::json::object const & level) {
+    names += level.at("name").as_string().c_str();
+    names += ' ';
+  });
+  return names;
+}
+
+TEST(TestLevelStream, levels_come_in_file_order) {
+  EXPECT_EQ("a b c ", level_names(R"({"levels": [{"name": "a"},
+                                                 {"name": "b"},
+                                                 {"name": "c"}]})"));
+  EXPECT_EQ("", level_names(R"({"levels": [ ]})"));
+}
+
+TEST(TestLevelStream, other_keys_are_skipped) {
+  // brackets and quotes inside strings don't end a value
+  EXPECT_EQ("x ", level_names(R"({
+      "comment": "not ] a } bracket \" [",
+      "tools": {"a": [1, 2, {"b": "]]"}], "c": null},
+      "version": 3,
+      "levels": [{"name": "x", "notes": "} {"}],
+      "after": [true, false]
+  })"));
+}
+
+TEST(TestLevelStream, rejects_bad_json_outside_the_levels) {
+  EXPECT_THROW(level_names(R"({"x": {], "levels": [{"name": "a"}]})"),
+               std::runtime_error);
+  EXPECT_THROW(level_names(R"({"x": [}, "levels": [{"name": "a"}]})"),
+               std::runtime_error);
+  EXPECT_THROW(level_names(R"({"x": garbage!!, "levels": []})"),
+               std::runtime_error);
+  EXPECT_THROW(level_names(R"({"x": "a" "b", "levels": []})"),
+               std::runtime_error);
+  EXPECT_THROW(level_names(R"({"levels": [], "x": nul})"),
+               std::runtime_error);
+  // inside the array, every level has to be an object
+  EXPECT_THROW(level_names(R"({"levels": [{"name": "a"}, 7]})"),
+               std::runtime_error);
+}
+
+TEST(TestLevelStream, nothing_but_whitespace_may_follow_the_file) {
+  EXPECT_EQ("a ", level_names("{\"levels\": [{\"name\": \"a\"}]}\n \t"));
+  EXPECT_THROW(level_names(R"({"levels": [{"name": "a"}]} {})"),
+               std::runtime_error);
+  EXPECT_THROW(level_names(R"({"levels": [{"name": "a"}]} garbage)"),
+               std::runtime_error);
+  EXPECT_THROW(level_names(R"({"levels": [{"name": "a"}]},)"),
+               std::runtime_error);
+}
+
+// That growing the buffer allocates nothing after the largest level is checked
+// in TestAllocations; this checks levels come through it whole.
+TEST(TestLevelStream, levels_of_any_size_come_through_the_buffer) {
+  // small, large, then small again, so the level buffer grows and then
+  // holds levels smaller than itself
+  std::string big(10000, 'b');
+  EXPECT_EQ("s " + big + " t ",
+            level_names(R"({"levels": [{"name": "s"}, {"name": ")" + big +
+                        R"("}, {"name": "t"}]})"));
+}
+
+TEST(TestLevelStream, rejects_files_without_levels) {
+  EXPECT_THROW(level_names(R"({"level": []})"), std::runtime_error);
+  EXPECT_THROW(level_names(R"([{"name": "a"}])"), std::runtime_error);
+  EXPECT_THROW(level_names(R"({"levels": [{"name": "a"})"),
+               std::runtime_error);
+  EXPECT_THROW(level_names(R"({"levels": []} [])"), std::runtime_error);
+}
+
+TEST(TestLevelStream, builds_the_same_graphs_as_the_loader) {
+  boost::json::array levels;
+  for (int i = 0; i < 10; ++i) {
+    levels.push_back(level(std::pair("name", "L" + std::to_string(i)),
+                           rules(from("a") = to(std::string(i + 1, 'b')),
+                                 from("b") = to("c", ""),
+                                 from("c") = to("a"))));
+  }
+  boost::json::value file_json =
+      boost::json::object{std::pair("levels", std::move(levels))};
+
+  auto path = fs::temp_directory_path() / "levelgen_level_stream.json";
+  std::ofstream(path) << boost::json::serialize(file_json);
+
+  std::vector<Graph> expected = p1::create_graphs_from_json(file_json, 1);
+  std::vector<Graph> streamed;
+  int                num_levels =
+      p1::for_each_graph_in_file(path.string(), [&](Graph && graph) {
+        streamed.push_back(std::move(graph));
+      });
+  fs::remove(path);
+
+  ASSERT_EQ(10, num_levels);
+  ASSERT_EQ(expected.size(), streamed.size());
+  for (std::size_t i = 0; i < expected.size(); ++i) {
+    EXPECT_EQ(expected[i].level_name(), streamed[i].level_name());
+    EXPECT_TRUE(expected[i].check_isomorphism(streamed[i]));
+  }
+}
+
+} // namespace test
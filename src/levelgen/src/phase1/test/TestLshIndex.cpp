@@ -0,0 +1,76 @@
+#include "Graph.hpp"
+#include "LshIndex.hpp"
+
+#include "graph_helpers.hpp"
+#include "jsonlevelconfig.hpp"
+
+#include <gtest/gtest.h>
+#include <boost/json.hpp>
+#include <stdexcept>
+
+namespace test {
+
+using namespace json;
+
+namespace {
+
+minhash::Signature
+signature_of(boost::json::object level) {
+  return make_graph(level).minhash_signature();
+}
+
+} // namespace
+
+TEST(TestLshIndex, invalid_band_count) {
+  EXPECT_THROW(LshIndex(0), std::runtime_error);
+  EXPECT_THROW(LshIndex(5), std::runtime_error);
+  EXPECT_NO_THROW(LshIndex(8));
+}
+
+TEST(TestLshIndex, empty_index_has_no_candidates) {
+  LshIndex index;
+  auto     sig = signature_of(level(rules(from("a") = to("b"))));
+  EXPECT_TRUE(index.query(sig).empty());
+}
+
+TEST(TestLshIndex, isomorphic_level_is_exact_candidate) {
+  LshIndex index;
+  // clang-format off
+  auto id1 = index.insert(signature_of(level(rules(from("a")  = to("bc"),
+                                                   from("bb") = to("")))));
+  auto id2 = index.insert(signature_of(level(rules(from("ab.") = to("a"),
+                                                   from("c")   = to("")))));
+  auto sig = signature_of(level(rules(from("cc") = to(""),
+                                      from("d")  = to("ec"))));
+  // clang-format on
+  EXPECT_EQ(0, id1);
+  EXPECT_EQ(1, id2);
+  EXPECT_EQ(2, index.size());
+
+  auto candidates = index.query(sig);
+  ASSERT_FALSE(candidates.empty());
+  EXPECT_EQ(id1, candidates[0].id);
+  EXPECT_EQ(1.0, candidates[0].similarity);
+}
+
+TEST(TestLshIndex, near_duplicate_is_candidate) {
+  LshIndex index(32); // 2 rows per band: lenient threshold
+  // clang-format off
+  index.insert(signature_of(level(rules(from("a")   = to("bc"),
+                                        from("b")   = to("c"),
+                                        from("ca")  = to("b"),
+                                        from("cc")  = to("")))));
+  auto sig = signature_of(level(rules(from("a")   = to("bc"),
+                                      from("b")   = to("c"),
+                                      from("ca")  = to("b"),
+                                      from("cc")  = to("a"))));
+  // clang-format on
+  auto candidates = index.query(sig);
+  ASSERT_EQ(1, candidates.size());
+  EXPECT_LT(candidates[0].similarity, 1.0);
+  EXPECT_GT(candidates[0].similarity, 0.0);
+
+  EXPECT_TRUE(index.query(sig, 1.0).empty());
+}
+
+} // namespace test
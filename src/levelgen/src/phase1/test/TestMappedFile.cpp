@@ -0,0 +1,69 @@
+#include "MappedFile.hpp"
+
+#include <gtest/gtest.h>
+
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+
+#include <sys/stat.h>
+
+namespace test {
+
+namespace fs = std::filesystem;
+
+// a fresh, empty directory for one test
+static fs::path
+scratch_dir(std::string const & name) {
+  auto dir = fs::temp_directory_path() / ("levelgen_" + name);
+  fs::remove_all(dir);
+  fs::create_directories(dir);
+  return dir;
+}
+
+static void
+write_file(fs::path const & path, std::string const & text) {
+  std::ofstream(path, std::ios::binary) << text;
+}
+
+TEST(TestMappedFile, maps_regular_files) {
+  auto path = scratch_dir("maps") / "levels.json";
+  std::string text(100000, 'x');
+  text.front() = '{';
+  text.back()  = '}';
+  write_file(path, text);
+
+  MappedFile file(path.string());
+  EXPECT_TRUE(file.is_mapped());
+  EXPECT_EQ(text, file.contents());
+}
+
+TEST(TestMappedFile, empty_file_is_empty) {
+  auto path = scratch_dir("empty") / "empty.json";
+  write_file(path, "");
+
+  MappedFile file(path.string());
+  EXPECT_TRUE(file.contents().empty());
+}
+
+TEST(TestMappedFile, reads_pipes) {
+  auto path = scratch_dir("pipes") / "fifo";
+  ASSERT_EQ(0, ::mkfifo(path.c_str(), 0600));
+
+  std::string  text(200000, 'p');
+  std::jthread writer([&] { write_file(path, text); });
+
+  MappedFile file(path.string());
+  EXPECT_FALSE(file.is_mapped());
+  EXPECT_EQ(text, file.contents());
+}
+
+TEST(TestMappedFile, missing_file_throws) {
+  auto path = scratch_dir("missing") / "nothing.json";
+  EXPECT_THROW(MappedFile{path.string()}, std::runtime_error);
+}
+
+} // namespace test
@@ -0,0 +1,149 @@
+#include "Graph.hpp"
+#include "StaticGraph.hpp"
+
+#include "graph_helpers.hpp"
+#include "jsonlevelconfig.hpp"
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <string>
+#include <utility>
+
+namespace test {
+
+namespace sg = static_graph;
+
+// a -> bc, b -> "": grouped by color, [T!!] [TRbc] [^FRa] [^FRb]
+constexpr auto simple = sg::StaticGraph<8>::build(
+    sg::rules(sg::from("a") = sg::to("bc"), sg::from("b") = sg::to("")));
+
+static_assert(simple.size() == 4);
+static_assert(simple.name_of(1) == "bc");
+static_assert(vertex::size(simple.vertex_at(1)) == 2);
+static_assert(vertex::get_start_bit(simple.vertex_at(2)));
+static_assert(vertex::get_start_bit(simple.vertex_at(3)));
+static_assert(simple.has_edge(2, 1));
+static_assert(simple.has_edge(3, 0));
+static_assert(not simple.has_edge(1, 0));
+
+// the same level with its blocks relabeled, and with its rules reordered
+constexpr auto relabeled = sg::StaticGraph<8>::build(
+    sg::rules(sg::from("c") = sg::to("cd"), sg::from("d") = sg::to("")));
+constexpr auto reordered = sg::StaticGraph<8>::build(
+    sg::rules(sg::from("b") = sg::to(""), sg::from("a") = sg::to("bc")));
+
+static_assert(simple.fingerprint() == relabeled.fingerprint());
+static_assert(simple.fingerprint() == reordered.fingerprint());
+
+// the pair that TestGraph.careful_reduce keeps apart
+constexpr auto reduce1 = sg::StaticGraph<8>::build(
+    sg::rules(sg::from("ab") = sg::to("b"), sg::from("b") = sg::to("")));
+constexpr auto reduce2 = sg::StaticGraph<8>::build(
+    sg::rules(sg::from("abbb") = sg::to(""), sg::from("b") = sg::to("bb", "")));
+
+static_assert(reduce1.fingerprint() != reduce2.fingerprint());
+
+// reference levels from resource/levels/standard.json
+// clang-format off
+constexpr auto april = sg::StaticGraph<32>::build(
+    sg::rules(sg::from("a")    = sg::to("bc"),
+              sg::from("abcd") = sg::to(""),
+              sg::from("bc")   = sg::to("bcd", "c"),
+              sg::from("cbc")  = sg::to("ab"),
+              sg::from("d")    = sg::to("a", "db"),
+              sg::from("db")   = sg::to("b")));
+
+constexpr auto i_remember_you = sg::StaticGraph<16>::build(
+    sg::rules(sg::from("a.a") = sg::to("1", ""),
+              sg::from("b")   = sg::to("")));
+
+// a run of 20 blocks, longer than one vertex holds, so the rest go into
+// continuation records
+constexpr auto long_run = sg::StaticGraph<32>::build(
+    sg::rules(sg::from("a") = sg::to("bbbbbbbbbbbbbbbbbbbb"),
+              sg::from("c") = sg::to("")));
+// clang-format on
+
+static_assert(long_run.size() == 4);
+
+TEST(TestStaticGraph, fingerprint_matches_runtime_graph) {
+  using namespace json;
+  // clang-format off
+  EXPECT_EQ(simple.fingerprint(),
+            make_graph(level(rules(from("a") = to("bc"),
+                                      from("b") = to("")))).fingerprint());
+  EXPECT_EQ(reduce1.fingerprint(),
+            make_graph(level(rules(from("ab") = to("b"),
+                                      from("b")  = to("")))).fingerprint());
+  EXPECT_EQ(reduce2.fingerprint(),
+            make_graph(level(rules(from("abbb") = to(""),
+                                      from("b")    = to("bb", ""))))
+                .fingerprint());
+  // clang-format on
+}
+
+TEST(TestStaticGraph, to_graph_is_isomorphic_to_runtime_graph) {
+  using namespace json;
+  auto lvl = level(rules(from("a") = to("bc"), from("b") = to("")));
+
+  Graph graph = simple.to_graph();
+  EXPECT_EQ(simple.size(), graph.vertices().size());
+  EXPECT_EQ(simple.fingerprint(), graph.fingerprint());
+  EXPECT_TRUE(graph.check_isomorphism(make_graph(lvl)));
+  EXPECT_TRUE(make_graph(lvl).check_isomorphism(graph));
+  EXPECT_FALSE(reduce1.to_graph().check_isomorphism(reduce2.to_graph()));
+  EXPECT_EQ("TRbc", graph.vertices().name_of(1));
+}
+
+TEST(TestStaticGraph, reference_levels_match_runtime_graphs) {
+  using namespace json;
+  // clang-format off
+  std::pair<Graph, Graph> levels[] = {
+      {april.to_graph("April"),
+       make_graph(level(rules(from("a")    = to("bc"),
+                                 from("abcd") = to(""),
+                                 from("bc")   = to("bcd", "c"),
+                                 from("cbc")  = to("ab"),
+                                 from("d")    = to("a", "db"),
+                                 from("db")   = to("b"))))},
+      {i_remember_you.to_graph("I remember you"),
+       make_graph(level(rules(from("a.a") = to("1", ""),
+                                 from("b")   = to(""))))},
+  };
+  // clang-format on
+
+  for (auto const & [compiled, runtime] : levels) {
+    EXPECT_EQ(runtime.vertices().size(), compiled.vertices().size());
+    EXPECT_EQ(runtime.fingerprint(), compiled.fingerprint());
+    EXPECT_TRUE(compiled.check_isomorphism(runtime));
+    EXPECT_TRUE(runtime.check_isomorphism(compiled));
+  }
+  EXPECT_EQ(april.fingerprint(), levels[0].second.fingerprint());
+  EXPECT_EQ(i_remember_you.fingerprint(), levels[1].second.fingerprint());
+}
+
+TEST(TestStaticGraph, long_runs_match_runtime_graph) {
+  using namespace json;
+  Graph runtime = make_graph(
+      level(rules(from("a") = to(std::string(20, 'b')), from("c") = to(""))));
+  Graph compiled = long_run.to_graph();
+
+  EXPECT_EQ(runtime.fingerprint(), long_run.fingerprint());
+  EXPECT_EQ(runtime.fingerprint(), compiled.fingerprint());
+  EXPECT_TRUE(compiled.check_isomorphism(runtime));
+  EXPECT_TRUE(runtime.check_isomorphism(compiled));
+
+  // every vertex sorts apart, so the two are in the same order
+  ASSERT_EQ(runtime.size(), long_run.size());
+  bool has_records = false;
+  for (int i = 0; i < long_run.size(); ++i) {
+    EXPECT_EQ(runtime.vertex_at(i), long_run.vertex_at(i));
+    EXPECT_TRUE(std::ranges::equal(runtime.continuation_of(i),
+                                   long_run.continuation_of(i)));
+    has_records = has_records || not long_run.continuation_of(i).empty();
+  }
+  EXPECT_TRUE(has_records);
+}
+
+} // namespace test
@@ -0,0 +1,37 @@
+#include "SuffixTrie.hpp"
+#include "color_constants.hpp"
+
+#include <gtest/gtest.h>
+
+using namespace color::test;
+
+TEST(TestSuffixTrie, equal_tails_share_nodes) {
+  SuffixTrie trie;
+  EXPECT_EQ(1, trie.size());
+
+  // "bcd", back to front
+  auto d   = trie.extend(SuffixTrie::Root, 'd', fc::rect_to);
+  auto cd  = trie.extend(d, 'c', fc::rect_to);
+  auto bcd = trie.extend(cd, 'b', fc::rect_to);
+  EXPECT_EQ(4, trie.size());
+
+  // "cd" again is found, not added
+  auto d2 = trie.extend(SuffixTrie::Root, 'd', fc::rect_to);
+  EXPECT_EQ(d, d2);
+  EXPECT_EQ(cd, trie.extend(d2, 'c', fc::rect_to));
+  EXPECT_EQ(4, trie.size());
+
+  // "acd" shares the "cd" tail but is its own node
+  auto acd = trie.extend(cd, 'a', fc::rect_to);
+  EXPECT_NE(bcd, acd);
+  EXPECT_EQ(5, trie.size());
+}
+
+TEST(TestSuffixTrie, color_is_part_of_the_symbol) {
+  SuffixTrie trie;
+  auto       to_d   = trie.extend(SuffixTrie::Root, 'd', fc::rect_to);
+  auto       from_d = trie.extend(SuffixTrie::Root, 'd', fc::rect_fm);
+  EXPECT_NE(to_d, from_d);
+  EXPECT_NE(trie.extend(to_d, 'c', fc::rect_to),
+            trie.extend(from_d, 'c', fc::rect_to));
+}
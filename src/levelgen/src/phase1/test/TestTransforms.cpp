@@ -82,6 +82,13 @@ TEST(TestTransforms, transform) {
   EXPECT_EQ(RuleSide::TO, get_rule_side(br2t_color));
   EXPECT_EQ(BACKREF, get_color(br2f_color));
   EXPECT_EQ(BACKREF, get_color(br2t_color));
+
+  EXPECT_EQ(b3, br3f_block);
+  EXPECT_EQ(b3, br3t_block);
+  EXPECT_EQ(RuleSide::FROM, get_rule_side(br3f_color));
+  EXPECT_EQ(RuleSide::TO, get_rule_side(br3t_color));
+  EXPECT_EQ(BACKREF, get_color(br3f_color));
+  EXPECT_EQ(BACKREF, get_color(br3t_color));
 }
 
 TEST(TestTransforms, unfinalize_block) {
@@ -130,4 +137,46 @@ TEST(TestTransforms, unfinalize_block) {
   EXPECT_EQ('3', t.unfinalize_block(b3, bref_to));
 }
 
+TEST(TestTransforms, overrides_copy_on_write) {
+  using enum color::Color;
+  using enum RuleSide;
+
+  Transforms defaults;
+  Transforms t;
+  t.add_level_type_override('a', json::rotating_colors("bc"));
+
+  // a copy sees the overrides made before it, but not those made after
+  Transforms copy = t;
+  t.add_level_type_override('b', json::rotating_colors("cd"));
+  copy.add_level_type_override('c', json::rotating_colors("de"));
+
+  EXPECT_EQ(NEXT_CUSTOM, get_color(t.to_color('a', FROM)));
+  EXPECT_EQ(NEXT_CUSTOM, get_color(copy.to_color('a', FROM)));
+  EXPECT_EQ(+NEXT_CUSTOM + 1, +get_color(t.to_color('b', FROM)));
+  EXPECT_EQ(SOLID_RECTANGLE, get_color(copy.to_color('b', FROM)));
+  EXPECT_EQ(SOLID_RECTANGLE, get_color(t.to_color('c', FROM)));
+  EXPECT_EQ(+NEXT_CUSTOM + 1, +get_color(copy.to_color('c', FROM)));
+
+  // and none of it touches the shared defaults
+  EXPECT_EQ(SOLID_RECTANGLE, get_color(defaults.to_color('a', FROM)));
+  EXPECT_EQ(SOLID_RECTANGLE, get_color(Transforms{}.to_color('b', TO)));
+  EXPECT_EQ(BACKREF, get_color(defaults.to_color('7', TO)));
+  EXPECT_EQ(WILDCARD, get_color(defaults.to_color('.', TO)));
+}
+
+TEST(TestTransforms, custom_color_names_are_reused) {
+  using enum color::Color;
+  using enum RuleSide;
+
+  Transforms t;
+  t.add_level_type_override('a', json::rotating_colors("bc"));
+  t.add_level_type_override('b', json::rotating_colors("cd"));
+  t.add_level_type_override('c', json::rotating_colors("bc"));
+
+  EXPECT_EQ(t.to_color('a', TO), t.to_color('c', TO));
+  EXPECT_NE(t.to_color('a', TO), t.to_color('b', TO));
+  EXPECT_EQ(2, std::distance(t.begin(), t.end()));
+  EXPECT_EQ("RotCol:bc", *t.begin());
+}
+
 } // namespace test
@@ -12,6 +12,10 @@ using enum VertexRole;
 
 using FinalColor = color::FinalColor;
 
+// These tests pin down the 32-bit encoding (6 blocks, 5 color bits), whatever
+// vertex type the build defaults to; the 64-bit ones name Vertex64.
+using Vertex = Vertex32;
+
 constexpr FinalColor frect_color = to_final_color(SOLID_RECTANGLE, FROM),
                      trect_color = to_final_color(SOLID_RECTANGLE, TO),
                      fwild_color = to_final_color(WILDCARD, FROM),
@@ -32,19 +36,20 @@ constexpr block::FinalBlock block4 = block::FinalBlock{4};
 constexpr block::FinalBlock block5 = block::FinalBlock{5};
 constexpr block::FinalBlock block6 = block::FinalBlock{6};
 
-constexpr Vertex v1           = create(frect_color, block1, INTERNAL);
+constexpr Vertex v1           = create<Vertex>(frect_color, block1, INTERNAL);
 constexpr Vertex v12          = add_block(v1, block2);
 constexpr Vertex v123         = add_block(v12, block3);
 constexpr Vertex v1234        = add_block(v123, block4);
 constexpr Vertex v12345       = add_block(v1234, block5);
 constexpr Vertex v123456      = add_block(v12345, block6);
-constexpr Vertex empty_vertex = create(frect_color, empty_block, INTERNAL);
+constexpr Vertex empty_vertex =
+    create<Vertex>(frect_color, empty_block, INTERNAL);
 
 struct VertexMaker {
   template <typename... BlockT>
   Vertex constexpr
   operator()(BlockT... blocks) const {
-    return create(color_, blocks..., INTERNAL);
+    return create<Vertex>(color_, blocks..., INTERNAL);
   }
   const color::FinalColor color_;
 };
@@ -59,15 +64,30 @@ TEST(TestVertex, enums) {
 }
 
 TEST(TestVertex, Constants) {
-  EXPECT_EQ(4, BitsPerBlock);
-  EXPECT_EQ(5, BitsForColor);
-  EXPECT_EQ(6, MaxBlocksPerVertex);
-  EXPECT_EQ(15, BlockMask);
-  EXPECT_EQ(31, ColorMask);
+  EXPECT_EQ(4, Layout32::BitsPerBlock);
+  EXPECT_EQ(5, Layout32::BitsForColor);
+  EXPECT_EQ(6, Layout32::MaxBlocksPerVertex);
+  EXPECT_EQ(15, Layout32::BlockMask);
+  EXPECT_EQ(31, Layout32::ColorMask);
+}
+
+// the 32-bit layout must keep the encoding it always had
+static_assert(Layout32::ColorShift == 24);
+static_assert(Layout32::StartBitShift == 29);
+static_assert(Layout32::AllBlocksMask == 0xFFFFFF);
+static_assert(Layout32::block_shift(0) == 20);
+
+TEST(TestVertex, Constants64) {
+  EXPECT_EQ(4, Layout64::BitsPerBlock);
+  EXPECT_EQ(8, Layout64::BitsForColor);
+  EXPECT_EQ(12, Layout64::MaxBlocksPerVertex);
+  EXPECT_EQ(48, Layout64::ColorShift);
+  EXPECT_EQ(56, Layout64::StartBitShift);
+  EXPECT_EQ(128, Layout64::MaxColors);
 }
 
 TEST(TestVeretx, start_bit) {
-  Vertex v1 = create(
+  Vertex v1 = create<Vertex>(
       frect_color, block1, block2, block3, block4, block5, block6, INTERNAL);
   EXPECT_FALSE(get_start_bit(v1));
   EXPECT_EQ(frect_color, get_final_color(v1));
@@ -89,12 +109,12 @@ TEST(TestVeretx, start_bit) {
 }
 
 TEST(TestVertex, VertexEncodingColor) {
-  Vertex v1 = create(frect_color, empty_block, INTERNAL);
+  Vertex v1 = create<Vertex>(frect_color, empty_block, INTERNAL);
   EXPECT_EQ(frect_color, get_final_color(v1));
 }
 
 TEST(TestVertex, test_add_block) {
-  Vertex v = create(frect_color, empty_block, INTERNAL);
+  Vertex v = create<Vertex>(frect_color, empty_block, INTERNAL);
   EXPECT_EQ(0, size(v));
 
   auto v1 = add_block(v, block1);
@@ -151,7 +171,7 @@ TEST(TestVertex, color_char_conversions) {
 }
 
 TEST(TestVertex, VertexEncodingGetBlockSingle) {
-  Vertex v1 = create(frect_color, block1, INTERNAL);
+  Vertex v1 = create<Vertex>(frect_color, block1, INTERNAL);
   EXPECT_EQ(block1, get_block(v1, 0));
   EXPECT_EQ(empty_block, get_block(v1, 1));
 
@@ -191,7 +211,7 @@ TEST(TestVertex, VertexEncodingGetBlockSingle) {
 }
 
 TEST(TestVertex, VertexEncodingGetBlocks) {
-  Vertex v1 = create(frect_color, block1, INTERNAL);
+  Vertex v1 = create<Vertex>(frect_color, block1, INTERNAL);
 
   auto blocks = get_blocks(v1);
   EXPECT_EQ(block1, blocks[0]);
@@ -241,12 +261,12 @@ TEST(TestVertex, same_color) {
   using namespace color;
   using enum Color;
 
-  Vertex v1 = create(frect_color, empty_block, INTERNAL),
-         v2 = create(trect_color, empty_block, INTERNAL),
-         v3 = create(fwild_color, empty_block, INTERNAL),
-         v4 = create(twild_color, empty_block, INTERNAL),
-         v5 = create(fbref_color, empty_block, INTERNAL),
-         v6 = create(tbref_color, empty_block, INTERNAL);
+  Vertex v1 = create<Vertex>(frect_color, empty_block, INTERNAL),
+         v2 = create<Vertex>(trect_color, empty_block, INTERNAL),
+         v3 = create<Vertex>(fwild_color, empty_block, INTERNAL),
+         v4 = create<Vertex>(twild_color, empty_block, INTERNAL),
+         v5 = create<Vertex>(fbref_color, empty_block, INTERNAL),
+         v6 = create<Vertex>(tbref_color, empty_block, INTERNAL);
 
   EXPECT_TRUE(same_color(v1, v1));
   EXPECT_TRUE(same_color(v2, v2));
@@ -277,7 +297,7 @@ TEST(TestVertex, same_color) {
 }
 
 TEST(TestVertex, capacity_funcs) {
-  Vertex v = create(frect_color, block1, INTERNAL);
+  Vertex v = create<Vertex>(frect_color, block1, INTERNAL);
 
   EXPECT_EQ(1, size(v));
   EXPECT_EQ(5, available_spaces(v));
@@ -310,8 +330,8 @@ TEST(TestVertex, capacity_funcs) {
 }
 
 TEST(TestVertex, num_can_merge) {
-  Vertex v  = create(frect_color, block1, INTERNAL);
-  Vertex v2 = create(frect_color, block1, block1, block1, INTERNAL);
+  Vertex v  = create<Vertex>(frect_color, block1, INTERNAL);
+  Vertex v2 = create<Vertex>(frect_color, block1, block1, block1, INTERNAL);
 
   // v has 1
   EXPECT_EQ(1, size(v));
@@ -336,8 +356,8 @@ TEST(TestVertex, num_can_merge) {
 }
 
 TEST(TestVertex, cannot_merge_start_vertex) {
-  Vertex v  = create(frect_color, block1, INTERNAL);
-  Vertex v2 = create(frect_color, block1, block1, block1, START);
+  Vertex v  = create<Vertex>(frect_color, block1, INTERNAL);
+  Vertex v2 = create<Vertex>(frect_color, block1, block1, block1, START);
 
   // v has 1
   EXPECT_EQ(1, size(v));
@@ -346,8 +366,8 @@ TEST(TestVertex, cannot_merge_start_vertex) {
 }
 
 TEST(TestVertex, can_merge_nonstart_into_start_vertex) {
-  Vertex v  = create(frect_color, block1, START);
-  Vertex v2 = create(frect_color, block1, block1, block1, INTERNAL);
+  Vertex v  = create<Vertex>(frect_color, block1, START);
+  Vertex v2 = create<Vertex>(frect_color, block1, block1, block1, INTERNAL);
 
   // v has 1
   EXPECT_EQ(1, size(v));
@@ -356,7 +376,7 @@ TEST(TestVertex, can_merge_nonstart_into_start_vertex) {
 }
 
 TEST(TestVertex, pop_front_small) {
-  Vertex v = create(frect_color, block1, block2, INTERNAL);
+  Vertex v = create<Vertex>(frect_color, block1, block2, INTERNAL);
   EXPECT_EQ(block1, get_block(v, 0));
   EXPECT_EQ(block2, get_block(v, 1));
 
@@ -365,16 +385,16 @@ TEST(TestVertex, pop_front_small) {
 }
 
 TEST(TestVertex, only_merge_compatible_colors) {
-  Vertex rect_fm = create(frect_color, block1, INTERNAL),
-         rect_to = create(trect_color, block1, INTERNAL),
-         wild_fm = create(fwild_color, block1, INTERNAL),
-         wild_to = create(twild_color, block1, INTERNAL),
-         noth_fm = create(fnoth_color, block1, INTERNAL),
-         noth_to = create(tnoth_color, block1, INTERNAL),
-         bref_fm = create(fbref_color, block1, INTERNAL),
-         bref_to = create(tbref_color, block1, INTERNAL),
-         rotc_fm = create(frotc_color, block1, INTERNAL),
-         rotc_to = create(trotc_color, block1, INTERNAL);
+  Vertex rect_fm = create<Vertex>(frect_color, block1, INTERNAL),
+         rect_to = create<Vertex>(trect_color, block1, INTERNAL),
+         wild_fm = create<Vertex>(fwild_color, block1, INTERNAL),
+         wild_to = create<Vertex>(twild_color, block1, INTERNAL),
+         noth_fm = create<Vertex>(fnoth_color, block1, INTERNAL),
+         noth_to = create<Vertex>(tnoth_color, block1, INTERNAL),
+         bref_fm = create<Vertex>(fbref_color, block1, INTERNAL),
+         bref_to = create<Vertex>(tbref_color, block1, INTERNAL),
+         rotc_fm = create<Vertex>(frotc_color, block1, INTERNAL),
+         rotc_to = create<Vertex>(trotc_color, block1, INTERNAL);
 
   EXPECT_TRUE(vertices_are_mergeable(rect_fm, rect_fm));
   EXPECT_TRUE(vertices_are_mergeable(rect_to, rect_to));
@@ -482,7 +502,7 @@ TEST(TestVertex, only_merge_compatible_colors) {
 }
 
 TEST(TestVertex, pop_front) {
-  Vertex v = create(
+  Vertex v = create<Vertex>(
       frect_color, block1, block2, block3, block4, block5, block6, INTERNAL);
   EXPECT_EQ(block1, get_block(v, 0));
   EXPECT_EQ(block2, get_block(v, 1));
@@ -549,7 +569,7 @@ TEST(TestVertex, pop_front) {
 }
 
 TEST(TestVertex, pop_front_multi) {
-  Vertex v = create(
+  Vertex v = create<Vertex>(
       frect_color, block1, block2, block3, block4, block5, block6, INTERNAL);
 
   v = pop_front(v, 3);
@@ -603,7 +623,7 @@ TEST(TestVertex, create_merged_onto_5_blocks) {
   Vertex actual5 = create_merged(v12345, v12345);
   Vertex actual6 = create_merged(v12345, v123456);
 
-  Vertex expected = create(
+  Vertex expected = create<Vertex>(
       frect_color, block1, block2, block3, block4, block5, block1, INTERNAL);
   EXPECT_EQ(expected, actual1);
   EXPECT_EQ(expected, actual2);
@@ -619,9 +639,49 @@ TEST(TestVertex, to_external_name) {
   EXPECT_EQ("[FROM:SOLID_RECTANGLE:abcd]", to_external_name(v1234, xforms));
 
   auto   twc_color  = to_final_color(color::Color::WILDCARD, RuleSide::TO);
-  Vertex wct_vertex = vertex::create(twc_color, block::FinalBlock{1}, INTERNAL);
+  Vertex wct_vertex = create<Vertex>(twc_color, block::FinalBlock{1}, INTERNAL);
   EXPECT_EQ("[T.:.]", to_external_short_name(wct_vertex, xforms));
   EXPECT_EQ("[TO:WILDCARD:.]", to_external_name(wct_vertex, xforms));
 }
 
+TEST(TestVertex, wide_vertex_holds_12_blocks) {
+  auto v = create<Vertex64>(frect_color, block1, INTERNAL);
+  for (int i = 1; i < 12; ++i) {
+    v = add_block(v, block::FinalBlock(1 + i % 15));
+  }
+  EXPECT_EQ(12, size(v));
+  EXPECT_TRUE(is_full(v));
+  EXPECT_EQ(0, available_spaces(v));
+  EXPECT_EQ(frect_color, get_final_color(v));
+  EXPECT_EQ(block::FinalBlock{12}, get_block(v, 11));
+  EXPECT_THROW(add_block(v, block1), std::runtime_error);
+}
+
+TEST(TestVertex, wide_vertex_holds_large_colors) {
+  auto const color = FinalColor{200};
+  auto       v     = create<Vertex64>(color, block3, START);
+  EXPECT_EQ(color, get_final_color(v));
+  EXPECT_TRUE(get_start_bit(v));
+  EXPECT_EQ(block3, get_block(v, 0));
+  EXPECT_EQ(1, size(v));
+}
+
+TEST(TestVertex, wide_vertex_pop_and_merge) {
+  auto v = create<Vertex64>(frect_color, block1, block2, block3, INTERNAL);
+  for (int i = 0; i < 6; ++i) {
+    v = add_block(v, block4);
+  }
+  auto w = create<Vertex64>(frect_color, block5, block6, INTERNAL);
+
+  EXPECT_EQ(2, num_can_merge(v, w));
+  auto merged = create_merged(v, w);
+  EXPECT_EQ(11, size(merged));
+  EXPECT_EQ(block6, get_block(merged, 10));
+
+  auto popped = pop_front(merged, 3);
+  EXPECT_EQ(8, size(popped));
+  EXPECT_EQ(block4, get_block(popped, 0));
+  EXPECT_EQ(block6, get_block(popped, 7));
+}
+
 } // namespace vertex::test
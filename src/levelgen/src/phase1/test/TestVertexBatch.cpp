@@ -0,0 +1,110 @@
+#include "Vertex.hpp"
+#include "VertexBatch.hpp"
+#include "color_constants.hpp"
+
+#include <gtest/gtest.h>
+#include <cstdint>
+#include <random>
+#include <vector>
+
+using namespace color::test;
+using vertex::VertexRole;
+
+namespace {
+
+// every color, start bit and size, in a pseudo-random order
+std::vector<vertex::Vertex>
+mixed_vertices(std::size_t count) {
+  std::mt19937                 rng(99);
+  std::vector<vertex::Vertex> vertices(count);
+  for (auto & v : vertices) {
+    vertex::Bits bits = vertex::Bits(rng() % 32) << vertex::ColorShift;
+    bits |= vertex::Bits(rng() % 2) << vertex::StartBitShift;
+    int sz = rng() % (vertex::MaxBlocksPerVertex + 1);
+    for (int i = 0; i < sz; ++i) {
+      bits |= vertex::Bits(1 + rng() % 15)
+              << vertex::DefaultLayout::block_shift(i);
+    }
+    v = vertex::Vertex{bits};
+  }
+  return vertices;
+}
+
+} // namespace
+
+TEST(TestVertexBatch, matches_scalar_at_every_length) {
+  auto const all = mixed_vertices(100);
+
+  // lengths around whole SIMD steps, so the scalar tail is exercised too
+  for (std::size_t n : {0, 1, 15, 16, 17, 31, 32, 33, 64, 100}) {
+    vertex::batch::VertexSpan in(all.data(), n);
+    std::vector<std::uint8_t> actual(n), expected(n);
+
+    vertex::batch::sizes(in, actual);
+    vertex::batch::scalar::sizes(in, expected);
+    EXPECT_EQ(expected, actual) << "sizes " << n;
+
+    vertex::batch::final_colors(in, actual);
+    vertex::batch::scalar::final_colors(in, expected);
+    EXPECT_EQ(expected, actual) << "final_colors " << n;
+
+    vertex::batch::start_bits(in, actual);
+    vertex::batch::scalar::start_bits(in, expected);
+    EXPECT_EQ(expected, actual) << "start_bits " << n;
+
+    vertex::batch::color_mask(in, fc::rect_to, actual);
+    vertex::batch::scalar::color_mask(in, fc::rect_to, expected);
+    EXPECT_EQ(expected, actual) << "color_mask " << n;
+  }
+}
+
+TEST(TestVertexBatch, size_histogram) {
+  using enum VertexRole;
+  auto const b = block::FinalBlock{1};
+
+  std::vector<vertex::Vertex> vertices{
+      vertex::create(fc::rect_to, b, INTERNAL),
+      vertex::create(fc::rect_to, b, b, b, START),
+      vertex::create(fc::wild_fm, b, INTERNAL),
+  };
+  vertex::batch::SizeHistogram expected{0, 2, 0, 1, 0, 0, 0};
+  EXPECT_EQ(expected, vertex::batch::size_histogram(vertices));
+
+  // more than one internal chunk
+  auto const many = mixed_vertices(1000);
+  vertex::batch::SizeHistogram many_expected{};
+  for (auto v : many) {
+    ++many_expected[vertex::size(v)];
+  }
+  EXPECT_EQ(many_expected, vertex::batch::size_histogram(many));
+}
+
+TEST(TestVertexBatch, same_colors_and_shapes) {
+  // more than one internal chunk, differing near the end
+  auto const a = mixed_vertices(600);
+  auto       b = a;
+  EXPECT_TRUE(vertex::batch::same_colors(a, b));
+  EXPECT_TRUE(vertex::batch::same_shapes(a, b));
+
+  std::size_t idx = 500;
+  while (vertex::size(a[idx]) == 0) {
+    ++idx;
+  }
+
+  // other blocks of the same size are a matter for the block map
+  auto const first_block = vertex::BlockMask << vertex::Block1Shift;
+  auto const other_block = vertex::get_block(a[idx], 0) == block::FinalBlock{1}
+                               ? vertex::Bits(2)
+                               : vertex::Bits(1);
+  b[idx] = vertex::Vertex{(+a[idx] & ~first_block) |
+                          other_block << vertex::Block1Shift};
+  EXPECT_TRUE(vertex::batch::same_shapes(a, b));
+
+  b[idx] = vertex::Vertex{+a[idx] ^ vertex::Bits(1) << vertex::StartBitShift};
+  EXPECT_TRUE(vertex::batch::same_colors(a, b));
+  EXPECT_FALSE(vertex::batch::same_shapes(a, b));
+
+  b[idx] = vertex::Vertex{+a[idx] ^ vertex::Bits(1) << vertex::ColorShift};
+  EXPECT_FALSE(vertex::batch::same_colors(a, b));
+  EXPECT_TRUE(vertex::batch::same_shapes(a, b));
+}
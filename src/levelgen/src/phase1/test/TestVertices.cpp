@@ -131,3 +131,152 @@ TEST(TestVertices, remove_vertex) {
   EXPECT_EQ(2, v.names().size());
   EXPECT_EQ(2, v.values().size());
 }
+
+TEST(TestVertices, name_index_follows_remove_and_swap) {
+  // enough names to force the index to grow a few times
+  Vertices                 v;
+  std::vector<std::string> names;
+  for (int i = 0; i < 100; ++i) {
+    names.push_back(std::to_string(i));
+    EXPECT_EQ(i, v.add_vertex_single(names.back(), block1, fc_rect_to, START));
+  }
+
+  auto expect_consistent = [&] {
+    ASSERT_EQ(names.size(), v.names_size());
+    for (int i = 0, sz = names.size(); i < sz; ++i) {
+      EXPECT_EQ(Vertices::internal_name(names[i], fc_rect_to), v.name_of(i));
+      EXPECT_EQ(i, v.name_index_of(names[i], fc_rect_to));
+    }
+  };
+  expect_consistent();
+
+  for (int i = 0; i < 50; i += 3) {
+    v.swap(i, 99 - i);
+    std::swap(names[i], names[99 - i]);
+  }
+  expect_consistent();
+
+  for (int i = 0; i < 40; ++i) {
+    int  doomed      = (i * 7) % names.size();
+    auto doomed_name = names[doomed];
+    v.remove_vertex(doomed);
+    names[doomed] = names.back();
+    names.pop_back();
+    EXPECT_EQ(-1, v.name_index_of(doomed_name, fc_rect_to));
+  }
+  expect_consistent();
+
+  EXPECT_EQ(names.size(),
+            v.add_vertex_single("new", block1, fc_rect_to, INTERNAL));
+}
+
+TEST(TestVertices, arena_names_keep_prefix_and_suffix_apart) {
+  Vertices v;
+  int      to_idx   = v.add_vertex_single("ab"sv, block1, fc_rect_to, START);
+  int      from_idx = v.add_vertex_single("ab"sv, block1, fc_rect_from, START);
+  EXPECT_NE(to_idx, from_idx);
+
+  EXPECT_EQ(Vertices::internal_name("ab"sv, fc_rect_to), v.name_of(to_idx));
+  EXPECT_EQ(Vertices::internal_name("ab"sv, fc_rect_from), v.name_of(from_idx));
+  EXPECT_EQ(from_idx, v.index_of_internal_name(v.name_of(from_idx)));
+
+  // too short to even hold the color prefix
+  EXPECT_EQ(-1, v.index_of_internal_name("T"sv));
+  EXPECT_EQ(-1, v.index_of_internal_name(""sv));
+}
+
+TEST(TestVertices, appended_vertices_are_found_by_name) {
+  Vertices v;
+  v.add_vertex_single("x"sv, block1, fc_rect_to, START);
+
+  // every suffix of "abc" names a vertex, sharing one copy of the text
+  auto text = v.add_name_text("abc"sv);
+  for (std::uint32_t i = 0; i < 3; ++i) {
+    EXPECT_EQ(i + 1, v.append_vertex(text + i, 3 - i, block2, fc_rect_to,
+                                     INTERNAL));
+  }
+
+  EXPECT_EQ("bc"sv, v.suffix_of(2));
+  EXPECT_EQ(Vertices::internal_name("bc"sv, fc_rect_to), v.name_of(2));
+  EXPECT_EQ(0, v.name_index_of("x"sv, fc_rect_to));
+  EXPECT_EQ(1, v.name_index_of("abc"sv, fc_rect_to));
+  EXPECT_EQ(3, v.name_index_of("c"sv, fc_rect_to));
+  EXPECT_EQ(-1, v.name_index_of("c"sv, fc_rect_from));
+
+  // adding by name after appending still finds the appended vertices
+  EXPECT_EQ(2, v.add_vertex_single("bc"sv, block2, fc_rect_to, INTERNAL));
+  EXPECT_EQ(4, v.add_vertex_single("b"sv, block2, fc_rect_to, INTERNAL));
+}
+
+TEST(TestVertices, field_arrays_follow_values) {
+  Vertices v;
+  v.add_vertex_single("a"sv, block1, fc_rect_to, INTERNAL);
+  v.add_vertex_single("b"sv, block2, fc_wc_from, START);
+  v.add_vertex_single("c"sv, block3, fc_rect_from, INTERNAL);
+
+  auto expect_in_step = [&] {
+    auto const & values = v.values();
+    ASSERT_EQ(values.size(), v.colors().size());
+    ASSERT_EQ(values.size(), v.start_bits().size());
+    ASSERT_EQ(values.size(), v.block_counts().size());
+    for (std::size_t i = 0; i < values.size(); ++i) {
+      EXPECT_EQ(+get_final_color(values[i]), v.colors()[i]);
+      EXPECT_EQ(get_start_bit(values[i]), v.start_bits()[i]);
+      EXPECT_EQ(vertex::size(values[i]), v.block_counts()[i]);
+    }
+  };
+  expect_in_step();
+
+  v.set_vertex(0, vertex::add_block(v[0], block2));
+  expect_in_step();
+  EXPECT_EQ(2, v.block_counts()[0]);
+
+  v.swap(0, 2);
+  expect_in_step();
+
+  v.add_vertex_single("c"sv, block3, fc_rect_from, START); // gains start bit
+  expect_in_step();
+  EXPECT_EQ(1, v.start_bits()[0]);
+
+  v.remove_vertex(0);
+  expect_in_step();
+}
+
+TEST(TestVertices, append_run_spills_into_continuation) {
+  // one block short of full, then 4 more: 3 spill over
+  constexpr int MaxBlocks = vertex::MaxBlocksPerVertex;
+  std::string   run_name(MaxBlocks + 3, 'a');
+
+  Vertices v;
+  v.add_vertex_single(run_name, block1, fc_rect_to, INTERNAL);
+  v.add_vertex_single("aaaa"sv, block1, fc_rect_to, INTERNAL);
+  v.add_vertex_single("x"sv, block3, fc_rect_from, INTERNAL);
+  for (int i = 0; i < MaxBlocks - 2; ++i) {
+    v.set_vertex(0, vertex::add_block(v[0], block1));
+  }
+  for (int i = 0; i < 3; ++i) {
+    v.set_vertex(1, vertex::add_block(v[1], block2));
+  }
+
+  v.append_run(0, 1);
+  EXPECT_EQ(MaxBlocks + 3, v.run_size(0));
+  EXPECT_EQ(MaxBlocks, vertex::size(v[0]));
+  ASSERT_EQ(1, v.continuation_of(0).size());
+  auto record = v.continuation_of(0)[0];
+  EXPECT_EQ(3, vertex::size(record));
+  EXPECT_EQ(fc_rect_to, get_final_color(record));
+  EXPECT_FALSE(get_start_bit(record));
+  EXPECT_EQ(block2, get_block(record, 2));
+
+  EXPECT_EQ(0, v.run_size(1));
+  EXPECT_TRUE(v.continuation_of(1).empty());
+
+  // the continuation follows its vertex when it moves
+  v.swap(0, 2);
+  EXPECT_EQ(MaxBlocks + 3, v.run_size(2));
+  EXPECT_TRUE(v.continuation_of(0).empty());
+
+  v.remove_vertex(0);
+  EXPECT_EQ(MaxBlocks + 3, v.run_size(0));
+  EXPECT_EQ(1, v.continuation_of(0).size());
+}
@@ -3,6 +3,8 @@
 #include "gtest/gtest.h"
 #include <vector>
 #include <cstddef>
+#include <cstdint>
+#include <random>
 
 void
 naive_but_correct(std::vector<std::size_t> & v) {
@@ -24,3 +26,20 @@ TEST(AlgoTest, test_swap_idx_and_val) {
     EXPECT_EQ(expected, actual);
   } while (std::next_permutation(begin(v), end(v)));
 }
+
+TEST(AlgoTest, radix_sort_matches_std_sort) {
+  std::mt19937_64 rng(42);
+  for (std::size_t n : {0, 1, 10, 100, 1000}) {
+    for (int shift : {0, 20, 40}) {
+      std::vector<std::uint64_t> keys(n);
+      for (auto & key : keys) {
+        // narrow keys leave whole bytes equal, which skip their pass
+        key = (rng() & 0xfff0ff) << shift;
+      }
+      auto expected = keys;
+      std::sort(begin(expected), end(expected));
+      algo::radix_sort(keys);
+      EXPECT_EQ(expected, keys);
+    }
+  }
+}
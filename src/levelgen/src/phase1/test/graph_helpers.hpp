@@ -0,0 +1,17 @@
+#pragma once
+
+#include "Graph.hpp"
+#include "GraphCreator.hpp"
+
+#include <boost/json.hpp>
+
+namespace test {
+
+// A level's graph as create_graphs builds it: compressed, then grouped by
+// colors. For the levels of jsonlevelconfig.hpp.
+inline Graph
+make_graph(boost::json::object const & level) {
+  return GraphCreator(level).compress_vertices().group_by_colors().create();
+}
+
+} // namespace test